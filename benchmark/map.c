@@ -0,0 +1,172 @@
+// micro-benchmark for YujiMap against the linear pair scan it replaced.
+// build and run with `make benchmark-map`
+
+#include "yuji/core/memory.h"
+#include "yuji/core/state.h"
+#include "yuji/core/types/dyn_array.h"
+#include "yuji/core/types/map.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+YujiState* G_YUJI_STATE = NULL;
+
+// the previous implementation: a dynamic array of heap pairs searched with strcmp
+typedef struct {
+  const char* key;
+  void* value;
+} LinearPair;
+
+static size_t linear_index_of(YujiDynArray* pairs, const char* key) {
+  for (size_t i = 0; i < pairs->size; i++) {
+    LinearPair* pair = yuji_dyn_array_get(pairs, i);
+
+    if (strcmp(pair->key, key) == 0) {
+      return i;
+    }
+  }
+
+  return (size_t) -1;
+}
+
+static void* linear_get(YujiDynArray* pairs, const char* key) {
+  size_t index = linear_index_of(pairs, key);
+  return index == (size_t) -1 ? NULL : ((LinearPair*)yuji_dyn_array_get(pairs, index))->value;
+}
+
+static void linear_set(YujiDynArray* pairs, const char* key, void* value) {
+  size_t index = linear_index_of(pairs, key);
+
+  if (index != (size_t) -1) {
+    ((LinearPair*)yuji_dyn_array_get(pairs, index))->value = value;
+    return;
+  }
+
+  LinearPair* pair = yuji_malloc(sizeof(LinearPair));
+  pair->key = strdup(key);
+  pair->value = value;
+  yuji_dyn_array_push(pairs, pair);
+}
+
+static void linear_free(YujiDynArray* pairs) {
+  YUJI_DYN_ARRAY_ITER(pairs, LinearPair, pair, {
+    yuji_free((void*)pair->key);
+    yuji_free(pair);
+  })
+  yuji_dyn_array_free(pairs);
+}
+
+static double now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// the linear scan is quadratic, so it gets fewer lookups on large tables
+static size_t lookups_for(size_t keys, bool linear) {
+  if (keys < 10000) {
+    return 10000;
+  }
+
+  return linear ? 1000 : 1000000;
+}
+
+static char** make_keys(size_t count) {
+  char** keys = yuji_malloc(sizeof(char*) * count);
+
+  for (size_t i = 0; i < count; i++) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "name_%zu", i * 2654435761u % 1000003u);
+    keys[i] = strdup(buf);
+  }
+
+  return keys;
+}
+
+// small tables are rebuilt several times so the timings are not dominated by
+// a single cold run
+static size_t rounds_for(size_t keys) {
+  return keys >= 10000 ? 1 : 10000 / keys;
+}
+
+static void bench(size_t count) {
+  char** keys = make_keys(count);
+  size_t rounds = rounds_for(count);
+  uintptr_t checksum = 0;
+
+  double linear_set_ns = 0, linear_get_ns = 0;
+  size_t linear_lookups = lookups_for(count, true);
+
+  for (size_t round = 0; round < rounds; round++) {
+    double start = now_ns();
+    YujiDynArray* linear = yuji_dyn_array_init();
+
+    for (size_t i = 0; i < count; i++) {
+      linear_set(linear, keys[i], (void*)(uintptr_t)(i + 1));
+    }
+
+    linear_set_ns += now_ns() - start;
+    start = now_ns();
+
+    for (size_t i = 0; i < linear_lookups; i++) {
+      checksum += (uintptr_t)linear_get(linear, keys[(i * 7919) % count]);
+    }
+
+    linear_get_ns += now_ns() - start;
+    linear_free(linear);
+  }
+
+  double map_set_ns = 0, map_get_ns = 0, map_remove_ns = 0;
+  size_t map_lookups = lookups_for(count, false);
+
+  for (size_t round = 0; round < rounds; round++) {
+    double start = now_ns();
+    YujiMap* map = yuji_map_init();
+
+    for (size_t i = 0; i < count; i++) {
+      yuji_map_set(map, keys[i], (void*)(uintptr_t)(i + 1));
+    }
+
+    map_set_ns += now_ns() - start;
+    start = now_ns();
+
+    for (size_t i = 0; i < map_lookups; i++) {
+      checksum += (uintptr_t)yuji_map_get(map, keys[(i * 7919) % count]);
+    }
+
+    map_get_ns += now_ns() - start;
+    start = now_ns();
+
+    for (size_t i = 0; i < count; i++) {
+      yuji_map_remove(map, keys[i]);
+    }
+
+    map_remove_ns += now_ns() - start;
+    yuji_map_free(map);
+  }
+
+  double inserts = (double)(count * rounds);
+
+  printf("%8zu keys | linear: set %9.1f ns  get %9.1f ns | map: set %6.1f ns  get %6.1f ns  remove %6.1f ns | %zu\n",
+         count, linear_set_ns / inserts, linear_get_ns / (double)(linear_lookups * rounds),
+         map_set_ns / inserts, map_get_ns / (double)(map_lookups * rounds), map_remove_ns / inserts,
+         (size_t)(checksum & 0xff));
+
+  for (size_t i = 0; i < count; i++) {
+    free(keys[i]);
+  }
+
+  yuji_free(keys);
+}
+
+int main() {
+  size_t sizes[] = { 8, 64, 1000, 100000 };
+
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    bench(sizes[i]);
+  }
+
+  return 0;
+}
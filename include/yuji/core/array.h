@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if !defined(YUJI_ARRAY_INITIAL_CAPACITY)
+#define YUJI_ARRAY_INITIAL_CAPACITY 8
+#endif
+
+struct YujiValue;
+
+// an array that has only ever held ints, or only floats, keeps them unboxed
+// in one contiguous buffer. storing an element of any other type converts it
+// to generic storage of value references for good. every slot is 8 bytes
+// wide, so the conversion rewrites the buffer in place
+typedef enum {
+  YUJI_ARRAY_EMPTY, // nothing stored yet, the first element picks the kind
+  YUJI_ARRAY_INT,
+  YUJI_ARRAY_FLOAT,
+  YUJI_ARRAY_GENERIC,
+} YujiArrayKind;
+
+typedef struct {
+  YujiArrayKind kind;
+  size_t size;
+  size_t capacity;
+  union {
+    int64_t* ints;
+    double* floats;
+    struct YujiValue** values;
+  } data;
+} YujiArray;
+
+YujiArray* yuji_array_init(size_t capacity);
+// an array of `size` slots of the given kind, which the caller must fill
+// before anything else reads or frees it
+YujiArray* yuji_array_alloc(YujiArrayKind kind, size_t size);
+void yuji_array_free(YujiArray* array);
+
+void yuji_array_reserve(YujiArray* array, size_t capacity);
+
+// returns a new reference to the element, `index` must be in bounds
+struct YujiValue* yuji_array_get(YujiArray* array, size_t index);
+// the setters take over the caller's reference to `value`
+void yuji_array_set(YujiArray* array, size_t index, struct YujiValue* value);
+void yuji_array_push(YujiArray* array, struct YujiValue* value);
+// hands the last element's reference to the caller, the array must not be empty
+struct YujiValue* yuji_array_pop(YujiArray* array);
+
+// boxes the elements so that values of any type can be stored
+void yuji_array_generalize(YujiArray* array);
@@ -1,16 +1,21 @@
 #pragma once
 
+#include "yuji/core/operator.h"
+#include "yuji/core/types/arena.h"
 #include "yuji/core/types/dyn_array.h"
 #include "yuji/core/types/string.h"
 #include <stdint.h>
 
 typedef struct YujiASTNode YujiASTNode;
 
-YujiASTNode* yuji_ast_node_copy(YujiASTNode* node);
+// copies a subtree into another arena
+YujiASTNode* yuji_ast_node_copy(YujiArena* arena, YujiASTNode* node);
 
+// every node, name and child list of a module lives in its arena
 typedef struct {
   const char* name;
   YujiDynArray* exprs;
+  YujiArena* arena;
 } YujiASTModule;
 
 typedef struct {
@@ -28,7 +33,7 @@ typedef struct {
 typedef struct {
   YujiASTNode* left;
   YujiASTNode* right;
-  char* operator;
+  YujiOperator operator;
 } YujiASTBinOp;
 
 typedef struct {
@@ -49,10 +54,13 @@ typedef struct {
   YujiDynArray* exprs;
 } YujiASTBlock;
 
+// function values share the node instead of copying the body, they hold a
+// reference to the arena so it outlives the module it was parsed in
 typedef struct {
   char* name;
   YujiDynArray* params;
   YujiASTNode* body;
+  YujiArena* arena;
 } YujiASTFunction;
 
 typedef struct {
@@ -163,9 +171,12 @@ struct YujiASTNode {
   } value;
 };
 
+// constructors allocate from the arena and adopt the nodes and strings passed
+// to them, which must come from the same arena. names are interned symbols
+// and child lists are copied
 #define YUJI_AST_INIT(NAME, TYPE, BODY, ...) \
-  YujiASTNode *yuji_ast_##NAME##_init(__VA_ARGS__) { \
-    YujiASTNode* node = yuji_malloc(sizeof(YujiASTNode)); \
+  YujiASTNode *yuji_ast_##NAME##_init(YujiArena* arena, ##__VA_ARGS__) { \
+    YujiASTNode* node = yuji_arena_alloc(arena, sizeof(YujiASTNode)); \
     node->type = TYPE;\
     BODY;\
     YUJI_LOG("creating node: %s (%d | %p)", yuji_ast_node_type_to_string(TYPE), TYPE, node); \
@@ -181,32 +192,33 @@ struct YujiASTNode {
   } while (0)
 
 
+// releases a module and everything parsed into it
 void yuji_ast_free(YujiASTNode* node);
 
 char* yuji_ast_node_type_to_string(YujiASTNodeType type);
 
-YujiASTNode* yuji_ast_module_init(const char* name, YujiDynArray* exprs);
-YujiASTNode* yuji_ast_int_init(int64_t value);
-YujiASTNode* yuji_ast_float_init(double value);
-YujiASTNode* yuji_ast_string_init(const char* value);
-YujiASTNode* yuji_ast_bin_op_init(YujiASTNode* left, const char* operator, YujiASTNode* right);
-YujiASTNode* yuji_ast_identifier_init(const char* name);
-YujiASTNode* yuji_ast_assign_init(const char* name, YujiASTNode* value);
-YujiASTNode* yuji_ast_let_init(const char* name, YujiASTNode* value);
-YujiASTNode* yuji_ast_block_init(YujiDynArray* exprs);
-YujiASTNode* yuji_ast_fn_init(const char* name, YujiDynArray* params, YujiASTBlock* body);
-YujiASTNode* yuji_ast_call_init(const char* name, YujiDynArray* args);
-YujiASTNode* yuji_ast_use_init(const char* value);
-YujiASTNode* yuji_ast_bool_init(bool value);
-YujiASTNode* yuji_ast_while_init(YujiASTNode* condition, YujiASTBlock* body);
-YujiASTIfBranch* yuji_ast_if_branch_init(YujiASTNode* condition, YujiASTBlock* body);
-YujiASTNode* yuji_ast_if_init(YujiDynArray* branches, YujiASTBlock* else_body);
+YujiASTNode* yuji_ast_module_init(YujiArena* arena, const char* name, YujiDynArray* exprs);
+YujiASTNode* yuji_ast_int_init(YujiArena* arena, int64_t value);
+YujiASTNode* yuji_ast_float_init(YujiArena* arena, double value);
+YujiASTNode* yuji_ast_string_init(YujiArena* arena, const char* value);
+YujiASTNode* yuji_ast_bin_op_init(YujiArena* arena, YujiASTNode* left, YujiOperator operator, YujiASTNode* right);
+YujiASTNode* yuji_ast_identifier_init(YujiArena* arena, const char* name);
+YujiASTNode* yuji_ast_assign_init(YujiArena* arena, const char* name, YujiASTNode* value);
+YujiASTNode* yuji_ast_let_init(YujiArena* arena, const char* name, YujiASTNode* value);
+YujiASTNode* yuji_ast_block_init(YujiArena* arena, YujiDynArray* exprs);
+YujiASTNode* yuji_ast_fn_init(YujiArena* arena, const char* name, YujiDynArray* params, YujiASTNode* body);
+YujiASTNode* yuji_ast_call_init(YujiArena* arena, const char* name, YujiDynArray* args);
+YujiASTNode* yuji_ast_use_init(YujiArena* arena, const char* value);
+YujiASTNode* yuji_ast_bool_init(YujiArena* arena, bool value);
+YujiASTNode* yuji_ast_while_init(YujiArena* arena, YujiASTNode* condition, YujiASTBlock* body);
+YujiASTIfBranch* yuji_ast_if_branch_init(YujiArena* arena, YujiASTNode* condition, YujiASTBlock* body);
+YujiASTNode* yuji_ast_if_init(YujiArena* arena, YujiDynArray* branches, YujiASTBlock* else_body);
 YujiASTBlock* yuji_ast_extract_block(YujiASTNode* block_node);
-YujiASTNode* yuji_ast_null_init();
-YujiASTNode* yuji_ast_return_init(YujiASTNode* value);
-YujiASTNode* yuji_ast_break_init();
-YujiASTNode* yuji_ast_continue_init();
-YujiASTNode* yuji_ast_array_init(YujiDynArray* elements);
-YujiASTNode* yuji_ast_index_access_init(YujiASTNode* object, YujiASTNode* index);
-YujiASTNode* yuji_ast_index_assign_init(YujiASTNode* object, YujiASTNode* index,
+YujiASTNode* yuji_ast_null_init(YujiArena* arena);
+YujiASTNode* yuji_ast_return_init(YujiArena* arena, YujiASTNode* value);
+YujiASTNode* yuji_ast_break_init(YujiArena* arena);
+YujiASTNode* yuji_ast_continue_init(YujiArena* arena);
+YujiASTNode* yuji_ast_array_init(YujiArena* arena, YujiDynArray* elements);
+YujiASTNode* yuji_ast_index_access_init(YujiArena* arena, YujiASTNode* object, YujiASTNode* index);
+YujiASTNode* yuji_ast_index_assign_init(YujiArena* arena, YujiASTNode* object, YujiASTNode* index,
                                         YujiASTNode* value);
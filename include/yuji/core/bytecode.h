@@ -0,0 +1,140 @@
+#pragma once
+
+#include "yuji/core/operator.h"
+#include "yuji/core/types/dyn_array.h"
+#include "yuji/core/value.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// every instruction is a single 32-bit word: low 8 bits hold the opcode,
+// the high 24 bits hold its argument (an index or a signed jump offset)
+typedef uint32_t YujiInstr;
+
+#define YUJI_INSTR_MAX_ARG 0xffffffu
+
+#define YUJI_INSTR(OP, ARG) ((YujiInstr)(OP) | ((YujiInstr)(ARG) << 8))
+#define YUJI_INSTR_OP(INSTR) ((YujiOpCode)((INSTR) & 0xff))
+#define YUJI_INSTR_ARG(INSTR) ((uint32_t)(INSTR) >> 8)
+#define YUJI_INSTR_SARG(INSTR) ((int32_t)(INSTR) >> 8)
+
+typedef enum {
+  OP_CONST, // push constants[arg]
+  OP_NULL,
+  OP_TRUE,
+  OP_FALSE,
+  OP_POP,
+
+  OP_GET_LOCAL, // push local slot arg of the current frame
+  OP_SET_LOCAL, // pop value, assign to local slot arg, push null
+  OP_DEFINE_LOCAL, // pop value, bind local slot arg, push null
+  OP_GET_OUTER, // push the local described by outers[arg]
+  OP_SET_OUTER, // pop value, assign to the local described by outers[arg], push null
+  OP_GET_GLOBAL, // push global slot arg
+  OP_SET_GLOBAL, // pop value, assign to existing global slot arg, push null
+  OP_DEFINE_GLOBAL, // pop value, bind unbound global slot arg, push null
+  OP_DEFINE_FUNCTION, // same as OP_DEFINE_GLOBAL, for named functions
+
+  OP_JUMP, // ip += arg
+  OP_JUMP_IF_FALSE, // pop condition, ip += arg if it is falsy
+
+  // binary operators, laid out in YujiOperator order. `&&` and `||` have no
+  // opcode, they compile to jumps so the right operand can be skipped
+  OP_ADD,
+  OP_SUB,
+  OP_MUL,
+  OP_DIV,
+  OP_MOD,
+  OP_LT,
+  OP_GT,
+  OP_LTE,
+  OP_GTE,
+  OP_EQ,
+  OP_NEQ,
+
+  OP_FUNCTION, // push function value for protos[arg]
+  OP_CALL, // call with arg arguments, next word is the callee name index
+  OP_TAIL_CALL, // same as OP_CALL, but a bytecode callee replaces the current frame
+  OP_RETURN,
+
+  OP_ARRAY, // pop arg elements, push array
+  OP_INDEX_GET,
+  OP_INDEX_SET,
+
+  OP_USE, // load module names[arg], push null
+
+  // superinstructions for common idioms, they name their operands with
+  // packed slots (see YUJI_SLOT) instead of taking them from the stack
+  OP_UPDATE, // `slot arg = slot arg op constant`, push null. next word is YUJI_INSTR(op, constant)
+  OP_COMPARE_JUMP, // ip += arg unless `left op right`. next words are YUJI_INSTR(op, left), right
+  OP_INDEX_SLOT, // push slot arg indexed by the slot in the next word
+
+  // int versions of the binary operators, in the same order. the generic
+  // opcode rewrites itself to its int version when both operands are ints,
+  // which rewrites itself back when they are not
+  OP_ADD_INT,
+  OP_SUB_INT,
+  OP_MUL_INT,
+  OP_DIV_INT,
+  OP_MOD_INT,
+  OP_LT_INT,
+  OP_GT_INT,
+  OP_LTE_INT,
+  OP_GTE_INT,
+  OP_EQ_INT,
+  OP_NEQ_INT,
+} YujiOpCode;
+
+#define YUJI_OPCODE_FROM_OPERATOR(OPERATOR) ((YujiOpCode)(OP_ADD + (OPERATOR)))
+#define YUJI_OPCODE_TO_OPERATOR(OP) ((YujiOperator)((OP) - OP_ADD))
+#define YUJI_OPCODE_TO_INT(OP) ((YujiOpCode)((OP) - OP_ADD + OP_ADD_INT))
+#define YUJI_OPCODE_FROM_INT(OP) ((YujiOpCode)((OP) - OP_ADD_INT + OP_ADD))
+
+// a slot names a local, a global or a constant of the running proto in 24
+// bits, so it fits an instruction argument
+#define YUJI_SLOT_LOCAL 0u
+#define YUJI_SLOT_GLOBAL 1u
+#define YUJI_SLOT_CONST 2u
+
+#define YUJI_SLOT_MAX_INDEX 0x3fffffu
+
+#define YUJI_SLOT(KIND, INDEX) (((uint32_t)(KIND) << 22) | (uint32_t)(INDEX))
+#define YUJI_SLOT_KIND(SLOT) (((uint32_t)(SLOT) >> 22) & 3)
+#define YUJI_SLOT_INDEX(SLOT) ((uint32_t)(SLOT) & YUJI_SLOT_MAX_INDEX)
+
+// a local of a lexically enclosing function, found at runtime in the nearest
+// frame that runs the proto with the given id
+typedef struct {
+  uint64_t proto_id;
+  size_t slot;
+  const char* name;
+} YujiProtoOuter;
+
+// every name a proto keeps is an interned symbol
+typedef struct YujiProto {
+  uint64_t id;
+  const char* name;
+  YujiDynArray* params;
+  YujiDynArray* locals; // slot names, parameters first
+  YujiDynArray* outers;
+  struct YujiScope* globals; // not owned, the scope the module was compiled against
+  YujiInstr* code;
+  size_t size;
+  size_t capacity;
+  YujiDynArray* constants;
+  YujiDynArray* names;
+  YujiDynArray* protos;
+  size_t max_stack;
+  int refcount;
+} YujiProto;
+
+const char* yuji_opcode_to_string(YujiOpCode op);
+
+YujiProto* yuji_proto_init(const char* name);
+void yuji_proto_free(YujiProto* proto);
+
+size_t yuji_proto_emit(YujiProto* proto, YujiInstr instr);
+size_t yuji_proto_add_constant(YujiProto* proto, YujiValue* value);
+size_t yuji_proto_add_name(YujiProto* proto, const char* name);
+size_t yuji_proto_add_local(YujiProto* proto, const char* name);
+size_t yuji_proto_add_outer(YujiProto* proto, YujiProto* owner, size_t slot);
+size_t yuji_proto_add_proto(YujiProto* proto, YujiProto* child);
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "yuji/core/ast.h"
+#include "yuji/core/bytecode.h"
+#include "yuji/core/interpreter.h"
+#include "yuji/core/types/dyn_array.h"
+#include <stddef.h>
+
+typedef struct {
+  size_t start;
+  size_t depth;
+  YujiDynArray* breaks;
+} YujiCompilerLoop;
+
+typedef struct {
+  const char* name;
+  size_t slot;
+  size_t scope_depth;
+} YujiCompilerLocal;
+
+// names are resolved while compiling: locals of the function being compiled
+// become frame slots, locals of enclosing functions become outers, and
+// everything else must be a global of the module
+typedef struct YujiCompiler {
+  YujiInterpreter* interpreter;
+  YujiScope* globals;
+  struct YujiCompiler* parent;
+  YujiProto* proto;
+  YujiDynArray* loops;
+  YujiDynArray* locals;
+  size_t depth;
+  size_t scope_depth;
+  bool is_function;
+  YujiDynArray* tail_calls; // positions of the calls in tail position
+  bool captured; // a nested function reads or writes one of the locals
+} YujiCompiler;
+
+YujiCompiler* yuji_compiler_init(YujiInterpreter* interpreter, YujiScope* globals,
+                                 YujiCompiler* parent, YujiProto* proto, bool is_function);
+void yuji_compiler_free(YujiCompiler* compiler);
+
+YujiProto* yuji_compiler_compile_module(YujiInterpreter* interpreter, YujiScope* globals,
+                                        YujiASTModule* module);
+YujiProto* yuji_compiler_compile_function(YujiCompiler* parent, YujiASTFunction* fn);
+
+void yuji_compiler_compile_block(YujiCompiler* compiler, YujiASTBlock* block);
+void yuji_compiler_compile(YujiCompiler* compiler, YujiASTNode* node);
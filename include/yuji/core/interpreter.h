@@ -5,32 +5,71 @@
 #include "yuji/core/types/map.h"
 #include "yuji/core/types/stack.h"
 #include "yuji/core/value.h"
+#include <stdio.h>
 
 
+// forward declaration
+struct YujiVM;
+struct YujiInterpreter;
+
+#if !defined(YUJI_SCOPE_POOL_SIZE)
+#define YUJI_SCOPE_POOL_SIZE 64
+#endif
+
+typedef enum {
+  YUJI_BACKEND_AST,
+  YUJI_BACKEND_VM,
+} YujiBackend;
+
+// names map to stable slot indexes (stored as index + 1) so compiled code can
+// address module globals by index. a declared slot holds NULL until assigned.
+// the name map and slot arrays are allocated on the first declaration.
+// keys are interned symbols, see yuji/core/symbol.h. bindings brought in by
+// `use` are marked `imported`, the module's own definitions may replace them.
+// `interpreter` is the one running code in the scope, native functions reach
+// it through the scope they are called with
 typedef struct YujiScope {
   YujiMap* env;
+  const char** names;
+  YujiValue** values;
+  bool* imported;
+  size_t size;
+  size_t capacity;
   struct YujiScope* parent;
+  struct YujiInterpreter* interpreter;
 } YujiScope;
 
 typedef struct {
   YujiScope* scope;
-  char* function_name;
+  const char* function_name;
   YujiDynArray* args;
-  bool has_return;
-  YujiValue* return_value;
 } YujiCallFrame;
 
-typedef struct {
-  bool has_break;
-  bool has_continue;
-} YujiLoopFrame;
+// how control leaves the node that was just evaluated. anything but
+// YUJI_FLOW_NORMAL makes every enclosing block stop, until the loop or the
+// function call it targets resets it. a `return` hands its value up as the
+// result of those nodes
+typedef enum {
+  YUJI_FLOW_NORMAL,
+  YUJI_FLOW_BREAK,
+  YUJI_FLOW_CONTINUE,
+  YUJI_FLOW_RETURN,
+} YujiFlow;
 
-typedef struct {
+// popped scopes are cleared and kept in `scope_pool` for the next push, so
+// `scope_allocations` only grows when scopes nest deeper than ever before.
+// `--mem-stats` reports it through yuji_interpreter_print_stats
+typedef struct YujiInterpreter {
   YujiScope* current_scope;
+  YujiDynArray* scope_pool;
+  size_t scope_allocations;
   YujiMap* loaded_modules;
   YujiStack* call_stack;
-  YujiStack* loop_stack;
+  YujiFlow flow;
+  size_t loop_depth; // loops running in the current function call
   size_t max_stack_size;
+  YujiBackend backend;
+  struct YujiVM* vm;
 } YujiInterpreter;
 
 // SCOPE
@@ -41,19 +80,49 @@ void yuji_scope_pop(YujiInterpreter* interpreter);
 YujiValue* yuji_scope_get(YujiScope* scope, const char* key);
 void yuji_scope_set(YujiScope* scope, const char* key, YujiValue* val);
 void yuji_scope_update(YujiScope* scope, const char* key, YujiValue* val);
+// binds every name of `src` in `dest` as imported
 void yuji_scope_merge(YujiScope* dest, YujiScope* src);
+// whether `key` is bound by a definition rather than by a `use`
+bool yuji_scope_defines(YujiScope* scope, const char* key);
+size_t yuji_scope_declare(YujiScope* scope, const char* key);
+size_t yuji_scope_index_of(YujiScope* scope, const char* key);
 
 // CALL FRAME
 YujiCallFrame* yuji_call_frame_init(YujiScope* scope, const char* name, YujiDynArray* args);
 void yuji_call_frame_free(YujiCallFrame* frame);
 
-// LOOP FRAME
-YujiLoopFrame* yuji_loop_frame_init();
-void yuji_loop_frame_free(YujiLoopFrame* frame);
+// CALLBACK
+#define YUJI_CALLBACK_MAX_ARGS 3
+
+// a function value that native code calls over and over, such as the
+// callback of std/array map. the arity is checked once by yuji_callback_init
+// and every call passes the borrowed references the caller left in `args`,
+// so iterations allocate no argument lists
+typedef struct {
+  YujiInterpreter* interpreter;
+  YujiValue* fn;
+  const char* name;
+  size_t argc;
+  YujiValue* args[YUJI_CALLBACK_MAX_ARGS];
+  YujiDynArray* native_args; // reused argument list when `fn` is native
+} YujiCallback;
+
+// `fn` is borrowed and must outlive the callback
+void yuji_callback_init(YujiCallback* callback, YujiInterpreter* interpreter, YujiValue* fn,
+                        size_t argc, const char* name);
+void yuji_callback_free(YujiCallback* callback);
+// returns a new reference
+YujiValue* yuji_callback_call(YujiCallback* callback);
 
 // INTERPRETER
 YujiInterpreter* yuji_interpreter_init();
 void yuji_interpreter_free(YujiInterpreter* interpreter);
+void yuji_interpreter_print_stats(YujiInterpreter* interpreter, FILE* stream);
+
+struct YujiModule* yuji_interpreter_find_module(YujiInterpreter* interpreter,
+                                               const char* module_name);
+void yuji_interpreter_load_module(YujiInterpreter* interpreter, const char* module_name);
+YujiValue* yuji_interpreter_run_module(YujiInterpreter* interpreter, YujiASTModule* module);
 
 YujiValue* yuji_interpreter_eval_module(YujiInterpreter* interpreter, YujiASTModule* module);
 YujiValue* yuji_interpreter_eval_block(YujiInterpreter* interpreter, YujiASTBlock* block);
@@ -1,25 +1,29 @@
 #pragma once
 
 #include "yuji/core/position.h"
-#include "yuji/core/types/dyn_array.h"
+#include "yuji/core/token.h"
+#include <stddef.h>
 
+// scans a length-delimited source buffer in place. the buffer has to outlive
+// the tokens, which point into it
 typedef struct {
-  YujiDynArray* input;
+  const char* source;
+  const char* current;
+  const char* end;
   YujiPosition position;
-  char current_char;
 } YujiLexer;
 
-YujiLexer* yuji_lexer_init(YujiDynArray* input, const char* file_name);
+YujiLexer* yuji_lexer_init(const char* source, size_t length, const char* file_name);
 void yuji_lexer_free(YujiLexer* lexer);
 
 char yuji_lexer_peek(YujiLexer* lexer);
 char yuji_lexer_peek_next(YujiLexer* lexer);
 char yuji_lexer_advance(YujiLexer* lexer);
 
-bool yuji_lexer_tokenize(YujiLexer* lexer, YujiDynArray *tokens);
+bool yuji_lexer_tokenize(YujiLexer* lexer, YujiTokenArray* tokens);
 
 void yuji_lexer_skip_whitespace(YujiLexer* lexer);
 
-char* yuji_lexer_parse_number(YujiLexer* lexer);
-char* yuji_lexer_parse_string(YujiLexer* lexer);
-char* yuji_lexer_parse_identifier_or_keyword(YujiLexer* lexer);
+void yuji_lexer_scan_number(YujiLexer* lexer);
+void yuji_lexer_scan_string(YujiLexer* lexer);
+void yuji_lexer_scan_identifier_or_keyword(YujiLexer* lexer);
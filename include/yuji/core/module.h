@@ -4,7 +4,7 @@
 #include "yuji/core/types/map.h"
 #include <stdint.h>
 
-typedef struct {
+typedef struct YujiModule {
   const char* name;
   YujiScope* scope;
   YujiMap* submodules;
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "yuji/core/token.h"
+
+typedef enum {
+  YUJI_OPERATOR_ADD, // +
+  YUJI_OPERATOR_SUB, // -
+  YUJI_OPERATOR_MUL, // *
+  YUJI_OPERATOR_DIV, // /
+  YUJI_OPERATOR_MOD, // %
+  YUJI_OPERATOR_LT, // <
+  YUJI_OPERATOR_GT, // >
+  YUJI_OPERATOR_LTE, // <=
+  YUJI_OPERATOR_GTE, // >=
+  YUJI_OPERATOR_EQ, // ==
+  YUJI_OPERATOR_NEQ, // !=
+  YUJI_OPERATOR_AND, // &&
+  YUJI_OPERATOR_OR, // ||
+} YujiOperator;
+
+#define YUJI_OPERATOR_COUNT (YUJI_OPERATOR_OR + 1)
+
+// forward declaration
+struct YujiValue;
+
+const char* yuji_operator_to_string(YujiOperator op);
+YujiOperator yuji_operator_from_token(YujiTokenType type);
+
+struct YujiValue* yuji_operator_eval(YujiOperator op, struct YujiValue* left,
+                                     struct YujiValue* right);
+// evaluates `x = x op y`, where `left` is also held by the variable that
+// receives the result. that reference is lent to the operation, so a string
+// only the variable holds can be extended in place
+struct YujiValue* yuji_operator_eval_update(YujiOperator op, struct YujiValue* left,
+                                            struct YujiValue* right);
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "yuji/core/ast.h"
+#include <stddef.h>
+#include <stdio.h>
+
+// rewrites a freshly parsed module in place, before either backend sees it:
+//
+//   - binary operators over int, float, bool and string literals are folded
+//     into a literal, unless evaluating them would panic
+//   - `if` branches whose condition is a literal are dropped or taken, and
+//     `while` loops whose condition is a falsy literal are removed
+//   - literals in statement position whose value is never used are dropped
+//
+// returns how many nodes the tree lost
+size_t yuji_optimizer_run(YujiASTModule* module);
+
+// totals over every module optimized so far
+void yuji_optimizer_print_stats(FILE* stream);
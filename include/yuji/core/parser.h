@@ -2,16 +2,19 @@
 
 #include "yuji/core/ast.h"
 #include "yuji/core/token.h"
+#include "yuji/core/types/arena.h"
 #include "yuji/core/types/dyn_array.h"
 #include <stdbool.h>
 
+// nodes are allocated from `arena`, which is handed over to the parsed module
 typedef struct {
-  YujiDynArray* tokens;
+  YujiTokenArray* tokens;
+  YujiArena* arena;
   size_t index;
   YujiToken* current_token;
 } YujiParser;
 
-YujiParser* yuji_parser_init(YujiDynArray* tokens);
+YujiParser* yuji_parser_init(YujiTokenArray* tokens);
 void yuji_parser_free(YujiParser* parser);
 
 YujiToken* yuji_parser_advance(YujiParser* parser);
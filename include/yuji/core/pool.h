@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+// size classes step by 8 bytes up to YUJI_POOL_MAX_SIZE, bigger requests go
+// straight to malloc
+#define YUJI_POOL_MAX_SIZE 64
+#define YUJI_POOL_CLASSES (YUJI_POOL_MAX_SIZE / 8)
+
+#if !defined(YUJI_POOL_SLAB_SIZE)
+#define YUJI_POOL_SLAB_SIZE 16384
+#endif
+
+typedef struct YujiPoolBlock {
+  struct YujiPoolBlock* next;
+} YujiPoolBlock;
+
+typedef struct YujiPoolSlab {
+  struct YujiPoolSlab* next;
+} YujiPoolSlab;
+
+// freed blocks are pushed on `free_list` and handed out again before the
+// current slab is carved any further
+typedef struct {
+  YujiPoolBlock* free_list;
+  YujiPoolSlab* slabs;
+  char* cursor;
+  char* end;
+  size_t live;
+  size_t peak;
+  size_t allocs;
+} YujiPoolClass;
+
+// slab allocator for the small headers that are created and dropped all the
+// time: values, strings and dynamic arrays. blocks are zeroed like
+// yuji_malloc, and must be returned with the size they were allocated with
+void* yuji_pool_alloc(size_t size);
+void yuji_pool_free(void* ptr, size_t size);
+
+// prints live, peak and total allocations per size class
+void yuji_pool_print_stats(FILE* stream);
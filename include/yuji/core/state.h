@@ -10,6 +10,8 @@ typedef struct {
 YujiState* yuji_state_init();
 void yuji_state_free(YujiState* state);
 
+void yuji_state_set_backend(YujiState* state, YujiBackend backend);
+
 YujiASTNode* yuji_get_ast(const char* string, const char* source_name);
 YujiASTNode* yuji_get_ast_from_file(const char* filename);
 
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if !defined(YUJI_SYMBOL_INITIAL_CAPACITY)
+#define YUJI_SYMBOL_INITIAL_CAPACITY 256
+#endif
+
+// interned names are unique, two symbols are equal exactly when their
+// pointers are, so they can be hashed and compared without reading the
+// characters. symbols are never freed
+const char* yuji_symbol_intern(const char* str);
+const char* yuji_symbol_intern_n(const char* str, size_t length);
+
+static inline uint32_t yuji_symbol_hash(const char* symbol) {
+  uint64_t bits = (uint64_t)(uintptr_t)symbol;
+
+  bits ^= bits >> 33;
+  bits *= 0xff51afd7ed558ccdULL;
+  bits ^= bits >> 33;
+
+  return (uint32_t)bits;
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "yuji/core/position.h"
+#include <stdbool.h>
+#include <stddef.h>
 
 typedef enum {
   // basic
@@ -54,14 +56,26 @@ typedef enum {
 
 const char* yuji_token_type_to_string(YujiTokenType type);
 
+// a view into the source buffer, `start` is not NUL-terminated. string
+// literals exclude the quotes and keep their escape sequences
 typedef struct {
-  const char* value;
+  const char* start;
+  size_t length;
   YujiTokenType type;
   YujiPosition position;
 } YujiToken;
 
-YujiToken* yuji_token_init(const char* value, const YujiTokenType type,
-                           const YujiPosition position);
-void yuji_token_free(YujiToken* token);
+// tokens are stored inline so lexing does not allocate per token
+typedef struct {
+  YujiToken* data;
+  size_t size;
+  size_t capacity;
+} YujiTokenArray;
+
+YujiTokenArray* yuji_token_array_init();
+void yuji_token_array_free(YujiTokenArray* tokens);
+void yuji_token_array_push(YujiTokenArray* tokens, YujiToken token);
 
+bool yuji_token_is(const YujiToken* token, const char* text);
+char* yuji_token_strdup(const YujiToken* token);
 const char* yuji_token_to_string(const YujiToken* token);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "yuji/core/types/dyn_array.h"
+#include <stddef.h>
+
+#if !defined(YUJI_ARENA_CHUNK_SIZE)
+#define YUJI_ARENA_CHUNK_SIZE 32768
+#endif
+
+#define YUJI_ARENA_ALIGNMENT 8
+
+typedef struct YujiArenaChunk {
+  struct YujiArenaChunk* next;
+  size_t size;
+  size_t used;
+} YujiArenaChunk;
+
+// bump allocator for data that dies all at once, such as a parsed module.
+// nothing is freed individually, the chunks are released when the last
+// reference is dropped
+typedef struct {
+  YujiArenaChunk* chunks;
+  size_t allocated;
+  int refcount;
+} YujiArena;
+
+YujiArena* yuji_arena_init();
+// drops a reference, the memory is released with the last one
+void yuji_arena_free(YujiArena* arena);
+
+void* yuji_arena_alloc(YujiArena* arena, size_t size);
+char* yuji_arena_strdup(YujiArena* arena, const char* str);
+char* yuji_arena_strndup(YujiArena* arena, const char* str, size_t length);
+// copies the items into a fixed-size array living in the arena, the result
+// must not be pushed to or freed
+YujiDynArray* yuji_arena_dyn_array(YujiArena* arena, YujiDynArray* items);
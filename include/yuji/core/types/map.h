@@ -1,21 +1,47 @@
 #pragma once
 
-#include "yuji/core/types/dyn_array.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
+#if !defined(YUJI_MAP_INITIAL_CAPACITY)
+#define YUJI_MAP_INITIAL_CAPACITY 8
+#endif
+
+// a slot of the open-addressing table. `distance` is the probe distance from
+// the home slot plus one, zero marks an empty slot
 typedef struct {
   const char* key;
   void* value;
+  uint32_t hash;
+  uint32_t distance;
 } YujiMapPair;
 
+// robin-hood hash table with inline slots and backward-shift deletion. the
+// slot array is allocated on first insert, so empty maps cost no allocation.
+// keys are copied, except in symbol maps which only take interned symbols
+// and hash and compare them by pointer
 typedef struct {
-  YujiDynArray* pairs;
+  YujiMapPair* pairs;
+  size_t size;
+  size_t capacity;
+  bool symbols;
 } YujiMap;
 
-YujiMapPair* yuji_map_pair_init(const char* key, void* value);
-void yuji_map_pair_free(YujiMapPair* pair);
+#define YUJI_MAP_ITER(MAP, VAR_NAME, BODY) \
+  for (size_t _iter_index_##VAR_NAME = 0; _iter_index_##VAR_NAME < MAP->capacity; _iter_index_##VAR_NAME++) { \
+    YujiMapPair* VAR_NAME = &MAP->pairs[_iter_index_##VAR_NAME]; \
+    if (VAR_NAME->distance == 0) { \
+      continue; \
+    } \
+    BODY \
+  }
 
 YujiMap* yuji_map_init();
+YujiMap* yuji_map_init_symbols();
 void yuji_map_free(YujiMap* map);
+// removes every pair but keeps the slot array
+void yuji_map_clear(YujiMap* map);
 
 void yuji_map_insert(YujiMap* map, const char* key, void* value);
 void yuji_map_remove(YujiMap* map, const char* key);
@@ -1,17 +1,63 @@
 #pragma once
 
+#include "yuji/core/types/arena.h"
 #include "yuji/core/types/dyn_array.h"
+#include <stdbool.h>
 #include <stddef.h>
 
+// bytes stored in the header itself, including the terminating NUL
+#define YUJI_STRING_INLINE_CAPACITY 16
+
+// `data` is always NUL-terminated. strings of up to
+// YUJI_STRING_INLINE_CAPACITY - 1 bytes keep their characters in `inline_`
+// and `data` points there; longer ones own a heap buffer of `capacity` bytes.
+// a capacity of 0 marks a shared read-only buffer, kept alive by a reference
+// to `owner` (or static when there is none) and copied on the first write.
+// strings are used through pointers only, a copied header would still point
+// at the original inline buffer
 typedef struct {
   char* data;
   size_t size;
-  size_t capacity;
+  union {
+    struct {
+      size_t capacity;
+      YujiArena* owner;
+    };
+    char inline_[YUJI_STRING_INLINE_CAPACITY];
+  } storage;
 } YujiString;
 
+static inline bool yuji_string_is_inline(const YujiString* str) {
+  return str->data == str->storage.inline_;
+}
+
+static inline bool yuji_string_is_shared(const YujiString* str) {
+  return !yuji_string_is_inline(str) && str->storage.capacity == 0;
+}
+
+static inline size_t yuji_string_capacity(const YujiString* str) {
+  return yuji_string_is_inline(str) ? YUJI_STRING_INLINE_CAPACITY : str->storage.capacity;
+}
+
 YujiString* yuji_string_init();
 YujiString* yuji_string_init_from_cstr(const char* cstr);
+YujiString* yuji_string_init_from_buffer(const char* buf, size_t len);
+// takes ownership of a NUL-terminated heap buffer of `len` bytes
+YujiString* yuji_string_adopt(char* data, size_t len);
+// refers to a NUL-terminated buffer that must not change while `owner` lives,
+// pass NULL for static storage
+YujiString* yuji_string_init_shared(const char* data, size_t len, YujiArena* owner);
+// another header for the characters of `str`, sharing them when they are
+// already shared and copying them otherwise
+YujiString* yuji_string_share(YujiString* str);
 void yuji_string_free(YujiString* str);
+// frees the header and returns the characters as a heap buffer
+char* yuji_string_detach(YujiString* str);
+
+// makes room for `size` bytes plus the NUL without further reallocation
+void yuji_string_reserve(YujiString* str, size_t size);
+// drops unused capacity, moving the characters inline when they fit
+void yuji_string_shrink(YujiString* str);
 
 void yuji_string_append_char(YujiString* sstr, char char_);
 void yuji_string_append_cstr(YujiString* str, const char* cstr);
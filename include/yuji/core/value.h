@@ -1,11 +1,14 @@
 #pragma once
 
+#include "yuji/core/array.h"
 #include "yuji/core/ast.h"
+#include "yuji/core/pool.h"
 #include "yuji/core/types/dyn_array.h"
 #include "yuji/core/types/string.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 typedef enum {
   VT_INT,
@@ -22,9 +25,11 @@ typedef struct YujiValue YujiValue;
 
 // forward declaration
 struct YujiScope;
+struct YujiProto;
 
 typedef struct {
   YujiASTFunction* node;
+  struct YujiProto* proto;
 } YujiFunction;
 
 typedef struct {
@@ -32,6 +37,17 @@ typedef struct {
   YujiValue* (*func)(struct YujiScope* scope, YujiDynArray* args);
 } YujiCFunction;
 
+// only strings, arrays, functions and numbers that do not fit a tag live on
+// the heap. every other value is encoded in the pointer bits and never
+// allocated, so freeing or referencing it is a no-op:
+//
+//   ...xxx1  int, 63-bit two's complement shifted left by one
+//   ...xx10  float whose exponent fits, the bits rotated left by three
+//   ...x100  null 0x04, false 0x0c, true 0x14
+//   ...x000  pointer to a heap value
+//
+// inspect values with yuji_value_type and the yuji_value_as_* accessors,
+// the fields below are only valid for heap values
 struct YujiValue {
   YujiValueType type;
   int refcount;
@@ -41,20 +57,125 @@ struct YujiValue {
     YujiFunction function;
     YujiString* string;
     YujiCFunction* cfunction;
-    bool bool_;
-    YujiDynArray* array;
+    YujiArray* array;
   } value;
 };
 
+_Static_assert(sizeof(uintptr_t) == 8, "tagged values need 64-bit pointers");
+
+#define YUJI_VALUE_NULL ((YujiValue*)(uintptr_t)0x04)
+#define YUJI_VALUE_FALSE ((YujiValue*)(uintptr_t)0x0c)
+#define YUJI_VALUE_TRUE ((YujiValue*)(uintptr_t)0x14)
+
+// +0.0 would rotate to the same bits as 0x3000000000000000, so it gets its own
+#define _YUJI_FLOAT_ZERO ((uintptr_t)0x8000000000000002)
+
 #define YUJI_VALUE_INIT(NAME, TYPE, BODY, ...) \
   YujiValue* yuji_value_##NAME##_init(__VA_ARGS__) { \
-    YujiValue* value = yuji_malloc(sizeof(YujiValue)); \
+    YujiValue* value = yuji_pool_alloc(sizeof(YujiValue)); \
     value->type = TYPE; \
     value->refcount = 1; \
     BODY; \
     return value; \
   }
 
+YujiValue* yuji_value_boxed_int_init(int64_t number);
+YujiValue* yuji_value_boxed_float_init(double number);
+
+static inline bool yuji_value_is_heap(YujiValue* value) {
+  return ((uintptr_t)value & 7) == 0;
+}
+
+static inline YujiValueType yuji_value_type(YujiValue* value) {
+  uintptr_t bits = (uintptr_t)value;
+
+  if (bits & 1) {
+    return VT_INT;
+  }
+
+  if (bits & 2) {
+    return VT_FLOAT;
+  }
+
+  if (bits & 4) {
+    return value == YUJI_VALUE_NULL ? VT_NULL : VT_BOOL;
+  }
+
+  return value->type;
+}
+
+static inline YujiValue* yuji_value_ref(YujiValue* value) {
+  if (yuji_value_is_heap(value)) {
+    value->refcount++;
+  }
+
+  return value;
+}
+
+static inline YujiValue* yuji_value_int_init(int64_t number) {
+  if (number < -((int64_t)1 << 62) || number >= ((int64_t)1 << 62)) {
+    return yuji_value_boxed_int_init(number);
+  }
+
+  return (YujiValue*)(((uintptr_t)number << 1) | 1);
+}
+
+static inline int64_t yuji_value_as_int(YujiValue* value) {
+  if ((uintptr_t)value & 1) {
+    return (int64_t)(uintptr_t)value >> 1;
+  }
+
+  return value->value.int_;
+}
+
+static inline YujiValue* yuji_value_float_init(double number) {
+  uint64_t bits;
+  memcpy(&bits, &number, sizeof(bits));
+  unsigned exponent = (unsigned)(bits >> 60) & 7;
+
+  if (bits != 0x3000000000000000 && (exponent == 3 || exponent == 4)) {
+    return (YujiValue*)((((bits << 3) | (bits >> 61)) & ~(uint64_t)1) | 2);
+  }
+
+  if (bits == 0) {
+    return (YujiValue*)_YUJI_FLOAT_ZERO;
+  }
+
+  return yuji_value_boxed_float_init(number);
+}
+
+static inline double yuji_value_as_float(YujiValue* value) {
+  uintptr_t tagged = (uintptr_t)value;
+
+  if (!(tagged & 2)) {
+    return value->value.float_;
+  }
+
+  if (tagged == _YUJI_FLOAT_ZERO) {
+    return 0.0;
+  }
+
+  // the two exponent bits dropped by the tag are recovered from the one kept
+  uint64_t bits = (2 - (tagged >> 63)) | (tagged & ~(uint64_t)3);
+  bits = (bits >> 3) | (bits << 61);
+
+  double number;
+  memcpy(&number, &bits, sizeof(number));
+  return number;
+}
+
+static inline YujiValue* yuji_value_bool_init(bool bool_) {
+  return bool_ ? YUJI_VALUE_TRUE : YUJI_VALUE_FALSE;
+}
+
+static inline bool yuji_value_as_bool(YujiValue* value) {
+  return value == YUJI_VALUE_TRUE;
+}
+
+static inline YujiValue* yuji_value_null_init() {
+  return YUJI_VALUE_NULL;
+}
+
 void yuji_value_free(YujiValue* value);
 
 bool yuji_value_to_bool(YujiValue* value);
@@ -62,12 +183,12 @@ char* yuji_value_to_string(YujiValue* value);
 char* yuji_value_type_to_string(YujiValueType type);
 bool yuji_value_type_is(YujiValueType type, YujiValueType expected);
 
-YujiValue* yuji_value_int_init(int64_t number);
-YujiValue* yuji_value_float_init(double number);
 YujiValue* yuji_value_function_init(YujiASTFunction* node);
+YujiValue* yuji_value_proto_init(struct YujiProto* proto);
 YujiValue* yuji_value_string_init(YujiString* string);
-YujiValue* yuji_value_null_init();
+// takes ownership of the string instead of copying it
+YujiValue* yuji_value_string_adopt_init(YujiString* string);
 YujiValue* yuji_value_cfunction_init(size_t argc,
                                      YujiValue * (*func)(struct YujiScope* scope, YujiDynArray* args));
-YujiValue* yuji_value_bool_init(bool bool_);
-YujiValue* yuji_value_array_init(YujiDynArray* array);
+// takes ownership of the array
+YujiValue* yuji_value_array_init(YujiArray* array);
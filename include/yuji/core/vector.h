@@ -0,0 +1,43 @@
+#pragma once
+
+#include "yuji/core/operator.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// bulk kernels over unboxed number buffers. on x86-64 each kernel has SSE2
+// and AVX2 versions next to the scalar one, picked on first use from what
+// the CPU supports. setting YUJI_SIMD to `scalar`, `sse2` or `avx2` in the
+// environment caps the choice.
+//
+// float sums and dot products accumulate in eight interleaved lanes that are
+// combined in a fixed order, so every version rounds the same way, though not
+// like a left-to-right loop would
+
+// false when the sum does not fit in an int64_t
+bool yuji_vector_sum_int(const int64_t* data, size_t size, int64_t* result);
+double yuji_vector_sum_float(const double* data, size_t size);
+
+// `size` must not be 0
+int64_t yuji_vector_min_int(const int64_t* data, size_t size);
+int64_t yuji_vector_max_int(const int64_t* data, size_t size);
+double yuji_vector_min_float(const double* data, size_t size);
+double yuji_vector_max_float(const double* data, size_t size);
+
+double yuji_vector_dot_float(const double* left, const double* right, size_t size);
+void yuji_vector_scale_float(double* out, const double* data, double factor, size_t size);
+
+// false when an element overflows, `out` is then partially written
+bool yuji_vector_add_int(int64_t* out, const int64_t* left, const int64_t* right, size_t size);
+void yuji_vector_add_float(double* out, const double* left, const double* right, size_t size);
+
+void yuji_vector_fill(uint64_t* out, uint64_t bits, size_t size);
+// `start + (size - 1) * step` must fit in an int64_t
+void yuji_vector_range(int64_t* out, int64_t start, int64_t step, size_t size);
+
+// writes `if_true` or `if_false` for each pair, `op` is one of the comparison
+// operators
+void yuji_vector_compare_int(uint64_t* out, const int64_t* left, const int64_t* right, size_t size,
+                             YujiOperator op, uint64_t if_true, uint64_t if_false);
+void yuji_vector_compare_float(uint64_t* out, const double* left, const double* right, size_t size,
+                               YujiOperator op, uint64_t if_true, uint64_t if_false);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "yuji/core/ast.h"
+#include "yuji/core/bytecode.h"
+#include "yuji/core/interpreter.h"
+#include "yuji/core/value.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// stack[base] holds the callee, the local slots of the proto follow it and
+// the operand stack starts right after them
+typedef struct {
+  YujiProto* proto;
+  YujiInstr* ip;
+  size_t base;
+  bool has_call_frame;
+} YujiVMFrame;
+
+typedef struct YujiVM {
+  YujiInterpreter* interpreter;
+
+  YujiValue** stack;
+  size_t stack_size;
+  size_t stack_capacity;
+
+  YujiVMFrame* frames;
+  size_t frame_count;
+  size_t frame_capacity;
+} YujiVM;
+
+YujiVM* yuji_vm_init(YujiInterpreter* interpreter);
+void yuji_vm_free(YujiVM* vm);
+
+YujiValue* yuji_vm_run(YujiVM* vm, YujiProto* proto);
+// calls a function value from native code, `args` are borrowed
+YujiValue* yuji_vm_call(YujiVM* vm, YujiValue* fn, YujiValue** args, size_t argc, const char* name);
+YujiValue* yuji_vm_eval_module(YujiVM* vm, YujiASTModule* module);
@@ -1,7 +1,10 @@
+#include "yuji/core/optimizer.h"
+#include "yuji/core/pool.h"
 #include "yuji/core/state.h"
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 YujiState* G_YUJI_STATE = NULL;
 
@@ -40,20 +43,64 @@ void ctrl_c_handler(int signal) {
   exit(signal);
 }
 
+void print_usage(const char* program) {
+  fprintf(stderr, "Usage: %s [--vm|--ast] [--mem-stats] [--opt-stats] [filename]\n", program);
+  fprintf(stderr, "  --vm         run scripts on the bytecode VM (default)\n");
+  fprintf(stderr, "  --ast        run scripts on the reference AST interpreter\n");
+  fprintf(stderr, "  --mem-stats  print memory pool statistics at exit\n");
+  fprintf(stderr, "  --opt-stats  print what the optimizer removed at exit\n");
+}
+
 int main(int argc, char* argv[]) {
   signal(SIGINT, ctrl_c_handler);
 
+  YujiBackend backend = YUJI_BACKEND_VM;
+  const char* filename = NULL;
+  bool mem_stats = false;
+  bool opt_stats = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--vm") == 0) {
+      backend = YUJI_BACKEND_VM;
+    } else if (strcmp(argv[i], "--ast") == 0) {
+      backend = YUJI_BACKEND_AST;
+    } else if (strcmp(argv[i], "--mem-stats") == 0) {
+      mem_stats = true;
+    } else if (strcmp(argv[i], "--opt-stats") == 0) {
+      opt_stats = true;
+    } else if (argv[i][0] != '-' && !filename) {
+      filename = argv[i];
+    } else {
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+
   G_YUJI_STATE = yuji_state_init();
-  int exit_code = 1;
+  yuji_state_set_backend(G_YUJI_STATE, backend);
+
+  int exit_code;
 
-  if (argc == 1) {
+  if (!filename) {
     exit_code = run_repl();
-  } else if (argc == 2) {
-    exit_code = run_file(argv[1]);
   } else {
-    fprintf(stderr, "Usage: %s [filename]\n", argv[0]);
+    exit_code = run_file(filename);
+  }
+
+  // scopes belong to the interpreter, pool blocks are counted once it is gone
+  if (mem_stats) {
+    yuji_interpreter_print_stats(G_YUJI_STATE->interpreter, stderr);
   }
 
   yuji_state_free(G_YUJI_STATE);
+
+  if (mem_stats) {
+    yuji_pool_print_stats(stderr);
+  }
+
+  if (opt_stats) {
+    yuji_optimizer_print_stats(stderr);
+  }
+
   return exit_code;
 }
@@ -0,0 +1,167 @@
+#include "yuji/core/array.h"
+#include "yuji/core/memory.h"
+#include "yuji/core/pool.h"
+#include "yuji/core/value.h"
+
+YujiArray* yuji_array_init(size_t capacity) {
+  YujiArray* array = yuji_pool_alloc(sizeof(YujiArray));
+
+  if (capacity < YUJI_ARRAY_INITIAL_CAPACITY) {
+    capacity = YUJI_ARRAY_INITIAL_CAPACITY;
+  }
+
+  array->kind = YUJI_ARRAY_EMPTY;
+  array->size = 0;
+  array->capacity = capacity;
+  array->data.values = yuji_malloc(sizeof(YujiValue*) * capacity);
+
+  return array;
+}
+
+YujiArray* yuji_array_alloc(YujiArrayKind kind, size_t size) {
+  YujiArray* array = yuji_array_init(size);
+
+  array->kind = size == 0 ? YUJI_ARRAY_EMPTY : kind;
+  array->size = size;
+
+  return array;
+}
+
+void yuji_array_free(YujiArray* array) {
+  if (array->kind == YUJI_ARRAY_GENERIC) {
+    for (size_t i = 0; i < array->size; i++) {
+      yuji_value_free(array->data.values[i]);
+    }
+  }
+
+  yuji_free(array->data.values);
+  yuji_pool_free(array, sizeof(YujiArray));
+}
+
+void yuji_array_reserve(YujiArray* array, size_t capacity) {
+  if (capacity <= array->capacity) {
+    return;
+  }
+
+  if (capacity < array->capacity * 2) {
+    capacity = array->capacity * 2;
+  }
+
+  array->data.values = yuji_realloc(array->data.values, sizeof(YujiValue*) * capacity);
+  array->capacity = capacity;
+}
+
+YujiValue* yuji_array_get(YujiArray* array, size_t index) {
+  switch (array->kind) {
+    case YUJI_ARRAY_INT:
+      return yuji_value_int_init(array->data.ints[index]);
+
+    case YUJI_ARRAY_FLOAT:
+      return yuji_value_float_init(array->data.floats[index]);
+
+    case YUJI_ARRAY_GENERIC:
+      return yuji_value_ref(array->data.values[index]);
+
+    case YUJI_ARRAY_EMPTY:
+      break;
+  }
+
+  yuji_panic("Array index out of bounds: %zu", index);
+}
+
+void yuji_array_generalize(YujiArray* array) {
+  switch (array->kind) {
+    case YUJI_ARRAY_INT:
+      for (size_t i = 0; i < array->size; i++) {
+        array->data.values[i] = yuji_value_int_init(array->data.ints[i]);
+      }
+      break;
+
+    case YUJI_ARRAY_FLOAT:
+      for (size_t i = 0; i < array->size; i++) {
+        array->data.values[i] = yuji_value_float_init(array->data.floats[i]);
+      }
+      break;
+
+    case YUJI_ARRAY_EMPTY:
+    case YUJI_ARRAY_GENERIC:
+      break;
+  }
+
+  array->kind = YUJI_ARRAY_GENERIC;
+}
+
+// makes the storage able to hold `value`
+static void array_accept(YujiArray* array, YujiValue* value) {
+  YujiArrayKind kind = YUJI_ARRAY_GENERIC;
+
+  switch (yuji_value_type(value)) {
+    case VT_INT:
+      kind = YUJI_ARRAY_INT;
+      break;
+
+    case VT_FLOAT:
+      kind = YUJI_ARRAY_FLOAT;
+      break;
+
+    default:
+      break;
+  }
+
+  if (array->kind == kind || array->kind == YUJI_ARRAY_GENERIC) {
+    return;
+  }
+
+  if (array->kind == YUJI_ARRAY_EMPTY) {
+    array->kind = kind;
+    return;
+  }
+
+  yuji_array_generalize(array);
+}
+
+// writes a slot that holds no reference, unboxed values are released
+static void array_store(YujiArray* array, size_t index, YujiValue* value) {
+  switch (array->kind) {
+    case YUJI_ARRAY_INT:
+      array->data.ints[index] = yuji_value_as_int(value);
+      yuji_value_free(value);
+      break;
+
+    case YUJI_ARRAY_FLOAT:
+      array->data.floats[index] = yuji_value_as_float(value);
+      yuji_value_free(value);
+      break;
+
+    case YUJI_ARRAY_GENERIC:
+    case YUJI_ARRAY_EMPTY:
+      array->data.values[index] = value;
+      break;
+  }
+}
+
+void yuji_array_set(YujiArray* array, size_t index, YujiValue* value) {
+  array_accept(array, value);
+
+  if (array->kind == YUJI_ARRAY_GENERIC) {
+    yuji_value_free(array->data.values[index]);
+  }
+
+  array_store(array, index, value);
+}
+
+void yuji_array_push(YujiArray* array, YujiValue* value) {
+  array_accept(array, value);
+  yuji_array_reserve(array, array->size + 1);
+  array_store(array, array->size++, value);
+}
+
+YujiValue* yuji_array_pop(YujiArray* array) {
+  if (array->kind == YUJI_ARRAY_GENERIC) {
+    return array->data.values[--array->size];
+  }
+
+  YujiValue* value = yuji_array_get(array, array->size - 1);
+  array->size--;
+  return value;
+}
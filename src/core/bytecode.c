@@ -0,0 +1,191 @@
+#include "yuji/core/bytecode.h"
+#include "yuji/core/memory.h"
+#include "yuji/core/symbol.h"
+#include "yuji/core/types/dyn_array.h"
+#include "yuji/core/value.h"
+#include "yuji/utils.h"
+#include <string.h>
+
+const char* yuji_opcode_to_string(YujiOpCode op) {
+#define _YUJI_OPCODE_CASE(op) case op: return #op
+
+  switch (op) {
+      _YUJI_OPCODE_CASE(OP_CONST);
+      _YUJI_OPCODE_CASE(OP_NULL);
+      _YUJI_OPCODE_CASE(OP_TRUE);
+      _YUJI_OPCODE_CASE(OP_FALSE);
+      _YUJI_OPCODE_CASE(OP_POP);
+      _YUJI_OPCODE_CASE(OP_GET_LOCAL);
+      _YUJI_OPCODE_CASE(OP_SET_LOCAL);
+      _YUJI_OPCODE_CASE(OP_DEFINE_LOCAL);
+      _YUJI_OPCODE_CASE(OP_GET_OUTER);
+      _YUJI_OPCODE_CASE(OP_SET_OUTER);
+      _YUJI_OPCODE_CASE(OP_GET_GLOBAL);
+      _YUJI_OPCODE_CASE(OP_SET_GLOBAL);
+      _YUJI_OPCODE_CASE(OP_DEFINE_GLOBAL);
+      _YUJI_OPCODE_CASE(OP_DEFINE_FUNCTION);
+      _YUJI_OPCODE_CASE(OP_JUMP);
+      _YUJI_OPCODE_CASE(OP_JUMP_IF_FALSE);
+      _YUJI_OPCODE_CASE(OP_ADD);
+      _YUJI_OPCODE_CASE(OP_SUB);
+      _YUJI_OPCODE_CASE(OP_MUL);
+      _YUJI_OPCODE_CASE(OP_DIV);
+      _YUJI_OPCODE_CASE(OP_MOD);
+      _YUJI_OPCODE_CASE(OP_LT);
+      _YUJI_OPCODE_CASE(OP_GT);
+      _YUJI_OPCODE_CASE(OP_LTE);
+      _YUJI_OPCODE_CASE(OP_GTE);
+      _YUJI_OPCODE_CASE(OP_EQ);
+      _YUJI_OPCODE_CASE(OP_NEQ);
+      _YUJI_OPCODE_CASE(OP_FUNCTION);
+      _YUJI_OPCODE_CASE(OP_CALL);
+      _YUJI_OPCODE_CASE(OP_TAIL_CALL);
+      _YUJI_OPCODE_CASE(OP_RETURN);
+      _YUJI_OPCODE_CASE(OP_ARRAY);
+      _YUJI_OPCODE_CASE(OP_INDEX_GET);
+      _YUJI_OPCODE_CASE(OP_INDEX_SET);
+      _YUJI_OPCODE_CASE(OP_USE);
+      _YUJI_OPCODE_CASE(OP_UPDATE);
+      _YUJI_OPCODE_CASE(OP_COMPARE_JUMP);
+      _YUJI_OPCODE_CASE(OP_INDEX_SLOT);
+      _YUJI_OPCODE_CASE(OP_ADD_INT);
+      _YUJI_OPCODE_CASE(OP_SUB_INT);
+      _YUJI_OPCODE_CASE(OP_MUL_INT);
+      _YUJI_OPCODE_CASE(OP_DIV_INT);
+      _YUJI_OPCODE_CASE(OP_MOD_INT);
+      _YUJI_OPCODE_CASE(OP_LT_INT);
+      _YUJI_OPCODE_CASE(OP_GT_INT);
+      _YUJI_OPCODE_CASE(OP_LTE_INT);
+      _YUJI_OPCODE_CASE(OP_GTE_INT);
+      _YUJI_OPCODE_CASE(OP_EQ_INT);
+      _YUJI_OPCODE_CASE(OP_NEQ_INT);
+  }
+
+  yuji_panic("Unknown opcode: %d", op);
+
+#undef _YUJI_OPCODE_CASE
+}
+
+// ids identify protos in running frames without keeping them alive
+static uint64_t next_proto_id = 1;
+
+YujiProto* yuji_proto_init(const char* name) {
+  YujiProto* proto = yuji_malloc(sizeof(YujiProto));
+
+  proto->id = next_proto_id++;
+  proto->name = yuji_symbol_intern(name);
+  proto->params = yuji_dyn_array_init();
+  proto->locals = yuji_dyn_array_init();
+  proto->outers = yuji_dyn_array_init();
+  proto->globals = NULL;
+  proto->capacity = 64;
+  proto->size = 0;
+  proto->code = yuji_malloc(sizeof(YujiInstr) * proto->capacity);
+  proto->constants = yuji_dyn_array_init();
+  proto->names = yuji_dyn_array_init();
+  proto->protos = yuji_dyn_array_init();
+  proto->max_stack = 0;
+  proto->refcount = 1;
+
+  return proto;
+}
+
+void yuji_proto_free(YujiProto* proto) {
+  yuji_check_memory(proto);
+
+  if (--proto->refcount != 0) {
+    return;
+  }
+
+  yuji_dyn_array_free(proto->params);
+  yuji_dyn_array_free(proto->locals);
+
+  YUJI_DYN_ARRAY_ITER(proto->outers, YujiProtoOuter, outer, {
+    yuji_free(outer);
+  })
+  yuji_dyn_array_free(proto->outers);
+
+  YUJI_DYN_ARRAY_ITER(proto->constants, YujiValue, constant, {
+    yuji_value_free(constant);
+  })
+  yuji_dyn_array_free(proto->constants);
+
+  yuji_dyn_array_free(proto->names);
+
+  YUJI_DYN_ARRAY_ITER(proto->protos, YujiProto, child, {
+    yuji_proto_free(child);
+  })
+  yuji_dyn_array_free(proto->protos);
+
+  yuji_free(proto->code);
+  yuji_free(proto);
+}
+
+size_t yuji_proto_emit(YujiProto* proto, YujiInstr instr) {
+  yuji_check_memory(proto);
+
+  if (proto->size == proto->capacity) {
+    proto->capacity *= 2;
+    proto->code = yuji_realloc(proto->code, sizeof(YujiInstr) * proto->capacity);
+  }
+
+  proto->code[proto->size] = instr;
+  return proto->size++;
+}
+
+size_t yuji_proto_add_constant(YujiProto* proto, YujiValue* value) {
+  yuji_check_memory(proto);
+
+  yuji_dyn_array_push(proto->constants, value);
+  return proto->constants->size - 1;
+}
+
+size_t yuji_proto_add_name(YujiProto* proto, const char* name) {
+  yuji_check_memory(proto);
+
+  name = yuji_symbol_intern(name);
+
+  for (size_t i = 0; i < proto->names->size; i++) {
+    if (proto->names->data[i] == name) {
+      return i;
+    }
+  }
+
+  yuji_dyn_array_push(proto->names, (void*)name);
+  return proto->names->size - 1;
+}
+
+size_t yuji_proto_add_proto(YujiProto* proto, YujiProto* child) {
+  yuji_check_memory(proto);
+
+  yuji_dyn_array_push(proto->protos, child);
+  return proto->protos->size - 1;
+}
+
+size_t yuji_proto_add_local(YujiProto* proto, const char* name) {
+  yuji_check_memory(proto);
+
+  yuji_dyn_array_push(proto->locals, (void*)yuji_symbol_intern(name));
+  return proto->locals->size - 1;
+}
+
+size_t yuji_proto_add_outer(YujiProto* proto, YujiProto* owner, size_t slot) {
+  yuji_check_memory(proto);
+  yuji_check_memory(owner);
+
+  for (size_t i = 0; i < proto->outers->size; i++) {
+    YujiProtoOuter* outer = proto->outers->data[i];
+
+    if (outer->proto_id == owner->id && outer->slot == slot) {
+      return i;
+    }
+  }
+
+  YujiProtoOuter* outer = yuji_malloc(sizeof(YujiProtoOuter));
+  outer->proto_id = owner->id;
+  outer->slot = slot;
+  outer->name = owner->locals->data[slot];
+
+  yuji_dyn_array_push(proto->outers, outer);
+  return proto->outers->size - 1;
+}
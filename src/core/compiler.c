@@ -0,0 +1,729 @@
+#include "yuji/core/compiler.h"
+#include "yuji/core/ast.h"
+#include "yuji/core/bytecode.h"
+#include "yuji/core/memory.h"
+#include "yuji/core/module.h"
+#include "yuji/core/types/dyn_array.h"
+#include "yuji/core/value.h"
+#include "yuji/utils.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+YujiCompiler* yuji_compiler_init(YujiInterpreter* interpreter, YujiScope* globals,
+                                 YujiCompiler* parent, YujiProto* proto, bool is_function) {
+  YujiCompiler* compiler = yuji_malloc(sizeof(YujiCompiler));
+
+  compiler->interpreter = interpreter;
+  compiler->globals = globals;
+  compiler->parent = parent;
+  compiler->proto = proto;
+  compiler->loops = yuji_dyn_array_init();
+  compiler->locals = yuji_dyn_array_init();
+  compiler->depth = 0;
+  compiler->scope_depth = 0;
+  compiler->is_function = is_function;
+  compiler->tail_calls = yuji_dyn_array_init();
+  compiler->captured = false;
+
+  return compiler;
+}
+
+void yuji_compiler_free(YujiCompiler* compiler) {
+  yuji_check_memory(compiler);
+
+  YUJI_DYN_ARRAY_ITER(compiler->locals, YujiCompilerLocal, local, {
+    yuji_free(local);
+  })
+  yuji_dyn_array_free(compiler->locals);
+  yuji_dyn_array_free(compiler->loops);
+  yuji_dyn_array_free(compiler->tail_calls);
+  yuji_free(compiler);
+}
+
+static uint32_t check_arg(size_t arg) {
+  if (arg > YUJI_INSTR_MAX_ARG) {
+    yuji_panic("compiler error: instruction argument %zu is too large", arg);
+  }
+
+  return (uint32_t)arg;
+}
+
+static size_t emit(YujiCompiler* compiler, YujiOpCode op, size_t arg, long effect) {
+  size_t pos = yuji_proto_emit(compiler->proto, YUJI_INSTR(op, check_arg(arg)));
+
+  compiler->depth = (size_t)((long)compiler->depth + effect);
+
+  if (compiler->depth > compiler->proto->max_stack) {
+    compiler->proto->max_stack = compiler->depth;
+  }
+
+  return pos;
+}
+
+static void patch_jump(YujiCompiler* compiler, size_t pos) {
+  long offset = (long)compiler->proto->size - (long)pos - 1;
+
+  if (offset > (long)(YUJI_INSTR_MAX_ARG >> 1)) {
+    yuji_panic("compiler error: jump is too long");
+  }
+
+  YujiOpCode op = YUJI_INSTR_OP(compiler->proto->code[pos]);
+  compiler->proto->code[pos] = YUJI_INSTR(op, (uint32_t)offset & YUJI_INSTR_MAX_ARG);
+}
+
+static void emit_loop(YujiCompiler* compiler, size_t start) {
+  long offset = (long)start - (long)compiler->proto->size - 1;
+
+  if (-offset > (long)(YUJI_INSTR_MAX_ARG >> 1)) {
+    yuji_panic("compiler error: loop body is too long");
+  }
+
+  yuji_proto_emit(compiler->proto, YUJI_INSTR(OP_JUMP, (uint32_t)offset & YUJI_INSTR_MAX_ARG));
+}
+
+static YujiCompilerLocal* find_local(YujiCompiler* compiler, const char* name) {
+  for (size_t i = compiler->locals->size; i-- > 0;) {
+    YujiCompilerLocal* local = compiler->locals->data[i];
+
+    if (local->name == name) {
+      return local;
+    }
+  }
+
+  return NULL;
+}
+
+static size_t declare_local(YujiCompiler* compiler, const char* name, const char* kind) {
+  if (find_local(compiler, name)) {
+    yuji_panic("%s %s already exists", kind, name);
+  }
+
+  YujiCompilerLocal* local = yuji_malloc(sizeof(YujiCompilerLocal));
+  local->name = name;
+  local->slot = yuji_proto_add_local(compiler->proto, name);
+  local->scope_depth = compiler->scope_depth;
+
+  yuji_dyn_array_push(compiler->locals, local);
+  return local->slot;
+}
+
+static bool is_top_level(YujiCompiler* compiler) {
+  return !compiler->is_function && compiler->scope_depth == 0;
+}
+
+// declares every name a module exports as a global, loading the module if it
+// is not loaded yet so that its names are known before the code runs
+static void import_module(YujiCompiler* compiler, const char* module_name) {
+  YujiModule* module = yuji_interpreter_find_module(compiler->interpreter, module_name);
+  YujiScope* scope = module->scope;
+
+  for (size_t i = 0; i < scope->size; i++) {
+    if (scope->values[i]) {
+      yuji_scope_declare(compiler->globals, scope->names[i]);
+    }
+  }
+}
+
+// emits the get (or set) instruction for a resolved name, returns false if
+// the name is not visible from here
+static bool emit_name(YujiCompiler* compiler, const char* name, bool set) {
+  YujiCompilerLocal* local = find_local(compiler, name);
+
+  if (local) {
+    emit(compiler, set ? OP_SET_LOCAL : OP_GET_LOCAL, local->slot, set ? 0 : 1);
+    return true;
+  }
+
+  for (YujiCompiler* outer = compiler->parent; outer; outer = outer->parent) {
+    local = find_local(outer, name);
+
+    if (local) {
+      outer->captured = true;
+      size_t index = yuji_proto_add_outer(compiler->proto, outer->proto, local->slot);
+      emit(compiler, set ? OP_SET_OUTER : OP_GET_OUTER, index, set ? 0 : 1);
+      return true;
+    }
+  }
+
+  size_t index = yuji_scope_index_of(compiler->globals, name);
+
+  if (index == (size_t) -1) {
+    return false;
+  }
+
+  emit(compiler, set ? OP_SET_GLOBAL : OP_GET_GLOBAL, index, set ? 0 : 1);
+  return true;
+}
+
+static YujiValue* literal_value(YujiASTNode* node) {
+  switch (node->type) {
+    case YUJI_AST_INT:
+      return yuji_value_int_init(node->value.int_->value);
+
+    case YUJI_AST_FLOAT:
+      return yuji_value_float_init(node->value.float_->value);
+
+    case YUJI_AST_STRING: {
+      // constants outlive the module, copy instead of pinning its arena
+      YujiString* string = node->value.string->value;
+      return yuji_value_string_adopt_init(yuji_string_init_from_buffer(string->data, string->size));
+    }
+
+    default:
+      yuji_panic("compiler error: %s is not a literal", yuji_ast_node_type_to_string(node->type));
+  }
+}
+
+// packs a local, a global or a literal into a slot operand for the
+// superinstructions, returns false for anything else. with `slot` NULL it
+// only checks, without adding constants
+static bool slot_operand(YujiCompiler* compiler, YujiASTNode* node, uint32_t* slot) {
+  uint32_t kind;
+  size_t index;
+
+  switch (node->type) {
+    case YUJI_AST_IDENTIFIER: {
+      const char* name = node->value.identifier->value;
+      YujiCompilerLocal* local = find_local(compiler, name);
+
+      if (local) {
+        kind = YUJI_SLOT_LOCAL;
+        index = local->slot;
+        break;
+      }
+
+      // locals of enclosing functions are found at runtime, they have no slot
+      for (YujiCompiler* outer = compiler->parent; outer; outer = outer->parent) {
+        if (find_local(outer, name)) {
+          return false;
+        }
+      }
+
+      kind = YUJI_SLOT_GLOBAL;
+      index = yuji_scope_index_of(compiler->globals, name);
+
+      if (index == (size_t) -1) {
+        return false;
+      }
+
+      break;
+    }
+
+    case YUJI_AST_INT:
+    case YUJI_AST_FLOAT:
+    case YUJI_AST_STRING:
+      kind = YUJI_SLOT_CONST;
+      index = compiler->proto->constants->size;
+
+      if (slot && index <= YUJI_SLOT_MAX_INDEX) {
+        yuji_proto_add_constant(compiler->proto, literal_value(node));
+      }
+
+      break;
+
+    default:
+      return false;
+  }
+
+  if (index > YUJI_SLOT_MAX_INDEX) {
+    return false;
+  }
+
+  if (slot) {
+    *slot = YUJI_SLOT(kind, index);
+  }
+
+  return true;
+}
+
+static bool is_comparison(YujiOperator operator) {
+  return operator >= YUJI_OPERATOR_LT && operator <= YUJI_OPERATOR_NEQ;
+}
+
+// emits the jump taken when `condition` is false. a comparison of two slots
+// becomes one OP_COMPARE_JUMP instead of two loads, the operator and the jump
+static size_t compile_jump_if_false(YujiCompiler* compiler, YujiASTNode* condition) {
+  if (condition->type == YUJI_AST_BIN_OP && is_comparison(condition->value.bin_op->operator) &&
+      slot_operand(compiler, condition->value.bin_op->left, NULL) &&
+      slot_operand(compiler, condition->value.bin_op->right, NULL)) {
+    YujiASTBinOp* compare = condition->value.bin_op;
+    uint32_t left;
+    uint32_t right;
+
+    slot_operand(compiler, compare->left, &left);
+    slot_operand(compiler, compare->right, &right);
+
+    size_t pos = emit(compiler, OP_COMPARE_JUMP, 0, 0);
+    yuji_proto_emit(compiler->proto, YUJI_INSTR(compare->operator, left));
+    yuji_proto_emit(compiler->proto, right);
+
+    return pos;
+  }
+
+  yuji_compiler_compile(compiler, condition);
+  return emit(compiler, OP_JUMP_IF_FALSE, 0, -1);
+}
+
+// `x = x op literal` with x a local or a global becomes one OP_UPDATE
+static bool compile_update(YujiCompiler* compiler, YujiASTAssign* assign) {
+  if (assign->value->type != YUJI_AST_BIN_OP) {
+    return false;
+  }
+
+  YujiASTBinOp* bin_op = assign->value->value.bin_op;
+
+  if (bin_op->operator > YUJI_OPERATOR_MOD || bin_op->left->type != YUJI_AST_IDENTIFIER ||
+      bin_op->left->value.identifier->value != assign->name) {
+    return false;
+  }
+
+  uint32_t target;
+  uint32_t constant;
+
+  if (bin_op->right->type == YUJI_AST_IDENTIFIER || !slot_operand(compiler, bin_op->right, NULL) ||
+      !slot_operand(compiler, bin_op->left, &target)) {
+    return false;
+  }
+
+  slot_operand(compiler, bin_op->right, &constant);
+
+  emit(compiler, OP_UPDATE, target, 1);
+  yuji_proto_emit(compiler->proto, YUJI_INSTR(bin_op->operator, YUJI_SLOT_INDEX(constant)));
+
+  return true;
+}
+
+// binds the value on top of the stack to a new name in the current scope
+static void emit_define(YujiCompiler* compiler, const char* name, bool is_function) {
+  if (is_top_level(compiler)) {
+    emit(compiler, is_function ? OP_DEFINE_FUNCTION : OP_DEFINE_GLOBAL,
+         yuji_scope_declare(compiler->globals, name), 0);
+    return;
+  }
+
+  // named functions are declared before their body is compiled so that they
+  // can call themselves
+  size_t slot = is_function ? find_local(compiler, name)->slot
+                            : declare_local(compiler, name, "variable");
+  emit(compiler, OP_DEFINE_LOCAL, slot, 0);
+}
+
+// unwinds the value stack down to the innermost loop body, used by break and
+// continue before jumping out of the current iteration
+static YujiCompilerLoop* unwind_loop(YujiCompiler* compiler, const char* keyword) {
+  if (compiler->loops->size == 0) {
+    yuji_panic("Cannot %s outside of a loop", keyword);
+  }
+
+  YujiCompilerLoop* loop = yuji_dyn_array_get(compiler->loops, compiler->loops->size - 1);
+  size_t depth = compiler->depth;
+
+  for (size_t i = loop->depth; i < depth; i++) {
+    emit(compiler, OP_POP, 0, -1);
+  }
+
+  emit(compiler, OP_NULL, 0, 1);
+  compiler->depth = depth + 1;
+
+  return loop;
+}
+
+static void compile_while(YujiCompiler* compiler, YujiASTWhile* while_stmt) {
+  emit(compiler, OP_NULL, 0, 1);
+
+  YujiCompilerLoop loop = {
+    .start = compiler->proto->size,
+    .depth = compiler->depth - 1,
+    .breaks = yuji_dyn_array_init(),
+  };
+
+  size_t exit_jump = compile_jump_if_false(compiler, while_stmt->condition);
+  emit(compiler, OP_POP, 0, -1);
+
+  yuji_dyn_array_push(compiler->loops, &loop);
+  yuji_compiler_compile_block(compiler, while_stmt->body);
+  yuji_dyn_array_pop(compiler->loops);
+
+  emit_loop(compiler, loop.start);
+  patch_jump(compiler, exit_jump);
+
+  YUJI_DYN_ARRAY_ITER(loop.breaks, void, jump, {
+    patch_jump(compiler, (size_t)(uintptr_t)jump);
+  })
+  yuji_dyn_array_free(loop.breaks);
+}
+
+static void compile_block(YujiCompiler* compiler, YujiASTBlock* block, bool tail);
+
+static void compile_if(YujiCompiler* compiler, YujiASTIf* if_stmt, bool tail) {
+  YujiDynArray* end_jumps = yuji_dyn_array_init();
+  size_t depth = compiler->depth;
+
+  YUJI_DYN_ARRAY_ITER(if_stmt->branches, YujiASTIfBranch, branch, {
+    size_t next_jump = compile_jump_if_false(compiler, branch->condition);
+
+    compile_block(compiler, branch->body, tail);
+    yuji_dyn_array_push(end_jumps, (void*)(uintptr_t)emit(compiler, OP_JUMP, 0, 0));
+
+    patch_jump(compiler, next_jump);
+    compiler->depth = depth;
+  })
+
+  if (if_stmt->else_body) {
+    compile_block(compiler, if_stmt->else_body, tail);
+  } else {
+    emit(compiler, OP_NULL, 0, 1);
+  }
+
+  YUJI_DYN_ARRAY_ITER(end_jumps, void, jump, {
+    patch_jump(compiler, (size_t)(uintptr_t)jump);
+  })
+  yuji_dyn_array_free(end_jumps);
+}
+
+// `&&` and `||` yield a bool and only evaluate the right operand when the left
+// one does not decide the result:
+//   a && b:  a; jf false; b; jf false; true; jmp end; false: false; end:
+//   a || b:  a; jf right; true; jmp end; right: b; jf false; true; jmp end; false: false; end:
+static void compile_logical(YujiCompiler* compiler, YujiASTBinOp* bin_op) {
+  bool is_and = bin_op->operator == YUJI_OPERATOR_AND;
+  size_t depth = compiler->depth;
+  size_t short_jump = 0;
+
+  yuji_compiler_compile(compiler, bin_op->left);
+  size_t left_jump = emit(compiler, OP_JUMP_IF_FALSE, 0, -1);
+
+  if (!is_and) {
+    emit(compiler, OP_TRUE, 0, 1);
+    short_jump = emit(compiler, OP_JUMP, 0, 0);
+    compiler->depth = depth;
+    patch_jump(compiler, left_jump);
+  }
+
+  yuji_compiler_compile(compiler, bin_op->right);
+  size_t right_jump = emit(compiler, OP_JUMP_IF_FALSE, 0, -1);
+  emit(compiler, OP_TRUE, 0, 1);
+  size_t end_jump = emit(compiler, OP_JUMP, 0, 0);
+  compiler->depth = depth;
+
+  patch_jump(compiler, right_jump);
+
+  if (is_and) {
+    patch_jump(compiler, left_jump);
+  }
+
+  emit(compiler, OP_FALSE, 0, 1);
+  patch_jump(compiler, end_jump);
+
+  if (!is_and) {
+    patch_jump(compiler, short_jump);
+  }
+}
+
+static void compile_call(YujiCompiler* compiler, YujiASTCall* call, bool tail) {
+  if (!emit_name(compiler, call->name, false)) {
+    yuji_panic("function %s not found", call->name);
+  }
+
+  size_t name = yuji_proto_add_name(compiler->proto, call->name);
+
+  YUJI_DYN_ARRAY_ITER(call->args, YujiASTNode, arg, {
+    yuji_compiler_compile(compiler, arg);
+  })
+
+  size_t pos = emit(compiler, OP_CALL, call->args->size, -(long)call->args->size);
+  yuji_proto_emit(compiler->proto, (YujiInstr)check_arg(name));
+
+  if (tail) {
+    yuji_dyn_array_push(compiler->tail_calls, (void*)(uintptr_t)pos);
+  }
+}
+
+// compiles an expression whose value the function returns right away. calls
+// there, also in the last expression of `if` branches, are tail calls
+static void compile_tail(YujiCompiler* compiler, YujiASTNode* node) {
+  switch (node->type) {
+    case YUJI_AST_CALL:
+      compile_call(compiler, node->value.call, true);
+      break;
+
+    case YUJI_AST_IF:
+      compile_if(compiler, node->value.if_stmt, true);
+      break;
+
+    case YUJI_AST_BLOCK:
+      compile_block(compiler, node->value.block, true);
+      break;
+
+    default:
+      yuji_compiler_compile(compiler, node);
+  }
+}
+
+YujiProto* yuji_compiler_compile_module(YujiInterpreter* interpreter, YujiScope* globals,
+                                        YujiASTModule* module) {
+  yuji_check_memory(interpreter);
+  yuji_check_memory(globals);
+  yuji_check_memory(module);
+
+  YujiProto* proto = yuji_proto_init(module->name);
+  proto->globals = globals;
+  YujiCompiler* compiler = yuji_compiler_init(interpreter, globals, NULL, proto, false);
+
+  // top-level names are visible to every function of the module, no matter
+  // where they are defined
+  YUJI_DYN_ARRAY_ITER(module->exprs, YujiASTNode, expr, {
+    if (expr->type == YUJI_AST_LET) {
+      yuji_scope_declare(globals, expr->value.let->name);
+    } else if (expr->type == YUJI_AST_FN && expr->value.fn->name) {
+      yuji_scope_declare(globals, expr->value.fn->name);
+    } else if (expr->type == YUJI_AST_USE) {
+      import_module(compiler, expr->value.use->value);
+    }
+  })
+
+  YUJI_DYN_ARRAY_ITER(module->exprs, YujiASTNode, expr, {
+    yuji_compiler_compile(compiler, expr);
+    emit(compiler, OP_POP, 0, -1);
+  })
+
+  emit(compiler, OP_NULL, 0, 1);
+  emit(compiler, OP_RETURN, 0, -1);
+
+  yuji_compiler_free(compiler);
+  return proto;
+}
+
+YujiProto* yuji_compiler_compile_function(YujiCompiler* parent, YujiASTFunction* fn) {
+  yuji_check_memory(parent);
+  yuji_check_memory(fn);
+
+  YujiProto* proto = yuji_proto_init(fn->name ? fn->name : "<anonymous>");
+  proto->globals = parent->globals;
+  YujiCompiler* compiler = yuji_compiler_init(parent->interpreter, parent->globals, parent, proto,
+                                              true);
+
+  YUJI_DYN_ARRAY_ITER(fn->params, char, param, {
+    yuji_dyn_array_push(proto->params, param);
+    declare_local(compiler, param, "parameter");
+  })
+
+  compile_block(compiler, fn->body->value.block, true);
+  emit(compiler, OP_RETURN, 0, -1);
+
+  // nested functions find the locals they use in this function's frame, so
+  // it can only be replaced when none of them does
+  if (!compiler->captured) {
+    YUJI_DYN_ARRAY_ITER(compiler->tail_calls, void, pos, {
+      YujiInstr* call = &proto->code[(size_t)(uintptr_t)pos];
+      *call = YUJI_INSTR(OP_TAIL_CALL, YUJI_INSTR_ARG(*call));
+    })
+  }
+
+  yuji_compiler_free(compiler);
+  return proto;
+}
+
+// with `tail` the value of the block is returned right away, so its last
+// expression is in tail position
+static void compile_block(YujiCompiler* compiler, YujiASTBlock* block, bool tail) {
+  compiler->scope_depth++;
+
+  if (block->exprs->size == 0) {
+    emit(compiler, OP_NULL, 0, 1);
+  }
+
+  for (size_t i = 0; i < block->exprs->size; i++) {
+    YujiASTNode* expr = yuji_dyn_array_get(block->exprs, i);
+
+    if (i + 1 < block->exprs->size) {
+      yuji_compiler_compile(compiler, expr);
+      emit(compiler, OP_POP, 0, -1);
+    } else if (tail) {
+      compile_tail(compiler, expr);
+    } else {
+      yuji_compiler_compile(compiler, expr);
+    }
+  }
+
+  compiler->scope_depth--;
+
+  // names declared in the block go out of scope, their slots are not reused
+  while (compiler->locals->size > 0) {
+    YujiCompilerLocal* local = compiler->locals->data[compiler->locals->size - 1];
+
+    if (local->scope_depth <= compiler->scope_depth) {
+      break;
+    }
+
+    yuji_free(yuji_dyn_array_pop(compiler->locals));
+  }
+}
+
+void yuji_compiler_compile_block(YujiCompiler* compiler, YujiASTBlock* block) {
+  yuji_check_memory(compiler);
+  yuji_check_memory(block);
+
+  compile_block(compiler, block, false);
+}
+
+void yuji_compiler_compile(YujiCompiler* compiler, YujiASTNode* node) {
+  yuji_check_memory(compiler);
+  yuji_check_memory(node);
+
+  YUJI_LOG("compiling node of type: %s (%p)", yuji_ast_node_type_to_string(node->type), node);
+
+  switch (node->type) {
+    case YUJI_AST_MODULE:
+      yuji_panic("compiler error: nested module");
+
+    case YUJI_AST_INT:
+    case YUJI_AST_FLOAT:
+    case YUJI_AST_STRING:
+      emit(compiler, OP_CONST, yuji_proto_add_constant(compiler->proto, literal_value(node)), 1);
+      break;
+
+    case YUJI_AST_BOOL:
+      emit(compiler, node->value.boolean->value ? OP_TRUE : OP_FALSE, 0, 1);
+      break;
+
+    case YUJI_AST_NULL:
+      emit(compiler, OP_NULL, 0, 1);
+      break;
+
+    case YUJI_AST_BIN_OP:
+      if (node->value.bin_op->operator == YUJI_OPERATOR_AND ||
+          node->value.bin_op->operator == YUJI_OPERATOR_OR) {
+        compile_logical(compiler, node->value.bin_op);
+        break;
+      }
+
+      yuji_compiler_compile(compiler, node->value.bin_op->left);
+      yuji_compiler_compile(compiler, node->value.bin_op->right);
+      emit(compiler, YUJI_OPCODE_FROM_OPERATOR(node->value.bin_op->operator), 0, -1);
+      break;
+
+    case YUJI_AST_IDENTIFIER:
+      if (!emit_name(compiler, node->value.identifier->value, false)) {
+        yuji_panic("name %s not found", node->value.identifier->value);
+      }
+
+      break;
+
+    case YUJI_AST_ASSIGN:
+      if (compile_update(compiler, node->value.assign)) {
+        break;
+      }
+
+      yuji_compiler_compile(compiler, node->value.assign->value);
+
+      if (!emit_name(compiler, node->value.assign->name, true)) {
+        yuji_panic("name %s not found", node->value.assign->name);
+      }
+
+      break;
+
+    case YUJI_AST_LET:
+      yuji_compiler_compile(compiler, node->value.let->value);
+      emit_define(compiler, node->value.let->name, false);
+      break;
+
+    case YUJI_AST_BLOCK:
+      yuji_compiler_compile_block(compiler, node->value.block);
+      break;
+
+    case YUJI_AST_FN: {
+      const char* name = node->value.fn->name;
+
+      if (name && !is_top_level(compiler)) {
+        declare_local(compiler, name, "function");
+      }
+
+      YujiProto* child = yuji_compiler_compile_function(compiler, node->value.fn);
+      emit(compiler, OP_FUNCTION, yuji_proto_add_proto(compiler->proto, child), 1);
+
+      if (name) {
+        emit_define(compiler, name, true);
+      }
+
+      break;
+    }
+
+    case YUJI_AST_CALL:
+      compile_call(compiler, node->value.call, false);
+      break;
+
+    case YUJI_AST_USE:
+      import_module(compiler, node->value.use->value);
+      emit(compiler, OP_USE, yuji_proto_add_name(compiler->proto, node->value.use->value), 1);
+      break;
+
+    case YUJI_AST_WHILE:
+      compile_while(compiler, node->value.while_stmt);
+      break;
+
+    case YUJI_AST_IF:
+      compile_if(compiler, node->value.if_stmt, false);
+      break;
+
+    case YUJI_AST_RETURN:
+      if (!compiler->is_function) {
+        yuji_panic("Cannot return from top-level code");
+      }
+
+      compile_tail(compiler, node->value.return_stmt->value);
+      emit(compiler, OP_RETURN, 0, 0);
+      break;
+
+    case YUJI_AST_BREAK: {
+      YujiCompilerLoop* loop = unwind_loop(compiler, "break");
+      yuji_dyn_array_push(loop->breaks, (void*)(uintptr_t)emit(compiler, OP_JUMP, 0, 0));
+      break;
+    }
+
+    case YUJI_AST_CONTINUE: {
+      YujiCompilerLoop* loop = unwind_loop(compiler, "continue");
+      emit_loop(compiler, loop->start);
+      break;
+    }
+
+    case YUJI_AST_ARRAY: {
+      YUJI_DYN_ARRAY_ITER(node->value.array->elements, YujiASTNode, element, {
+        yuji_compiler_compile(compiler, element);
+      })
+
+      size_t count = node->value.array->elements->size;
+      emit(compiler, OP_ARRAY, count, 1 - (long)count);
+      break;
+    }
+
+    case YUJI_AST_INDEX_ACCESS: {
+      YujiASTIndexAccess* access = node->value.index_access;
+      uint32_t object;
+      uint32_t index;
+
+      if (access->object->type == YUJI_AST_IDENTIFIER && slot_operand(compiler, access->object, NULL) &&
+          slot_operand(compiler, access->index, NULL)) {
+        slot_operand(compiler, access->object, &object);
+        slot_operand(compiler, access->index, &index);
+
+        emit(compiler, OP_INDEX_SLOT, object, 1);
+        yuji_proto_emit(compiler->proto, index);
+        break;
+      }
+
+      yuji_compiler_compile(compiler, access->object);
+      yuji_compiler_compile(compiler, access->index);
+      emit(compiler, OP_INDEX_GET, 0, -1);
+      break;
+    }
+
+    case YUJI_AST_INDEX_ASSIGN:
+      yuji_compiler_compile(compiler, node->value.index_assign->object);
+      yuji_compiler_compile(compiler, node->value.index_assign->index);
+      yuji_compiler_compile(compiler, node->value.index_assign->value);
+      emit(compiler, OP_INDEX_SET, 0, -2);
+      break;
+  }
+}
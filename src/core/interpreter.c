@@ -2,14 +2,18 @@
 #include "yuji/core/ast.h"
 #include "yuji/core/memory.h"
 #include "yuji/core/module.h"
+#include "yuji/core/operator.h"
 #include "yuji/core/state.h"
+#include "yuji/core/symbol.h"
 #include "yuji/core/types/dyn_array.h"
 #include "yuji/core/types/map.h"
 #include "yuji/core/types/stack.h"
 #include "yuji/core/types/string.h"
 #include "yuji/core/value.h"
+#include "yuji/core/vm.h"
 #include "yuji/utils.h"
 #include "yuji/stdlib/_std.h"
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <dirent.h>
@@ -21,40 +25,121 @@ extern YujiState* G_YUJI_STATE;
 YujiScope* yuji_scope_init(YujiScope* parent) {
   YujiScope* scope = yuji_malloc(sizeof(YujiScope));
 
-  scope->env = yuji_map_init();
+  scope->env = NULL;
+  scope->names = NULL;
+  scope->values = NULL;
+  scope->imported = NULL;
+  scope->size = 0;
+  scope->capacity = 0;
   scope->parent = parent;
+  scope->interpreter = parent ? parent->interpreter : NULL;
 
   return scope;
 }
 
+// drops the bindings but keeps the slot storage for the next user
+static void scope_clear(YujiScope* scope) {
+  for (size_t i = 0; i < scope->size; i++) {
+    if (scope->values[i]) {
+      yuji_value_free(scope->values[i]);
+    }
+  }
+
+  if (scope->env) {
+    yuji_map_clear(scope->env);
+  }
+
+  scope->size = 0;
+}
+
 void yuji_scope_free(YujiScope* scope) {
-  YUJI_DYN_ARRAY_ITER(scope->env->pairs, YujiMapPair, pair, {
-    yuji_value_free(pair->value);
-  })
+  scope_clear(scope);
+
+  if (scope->values) {
+    yuji_free(scope->values);
+    yuji_free(scope->names);
+    yuji_free(scope->imported);
+  }
 
   yuji_map_free(scope->env);
   yuji_free(scope);
 }
 
 void yuji_scope_push(YujiInterpreter* interpreter) {
-  interpreter->current_scope = yuji_scope_init(interpreter->current_scope);
+  YujiScope* scope;
+
+  if (interpreter->scope_pool->size > 0) {
+    scope = yuji_dyn_array_pop(interpreter->scope_pool);
+    scope->parent = interpreter->current_scope;
+  } else {
+    scope = yuji_scope_init(interpreter->current_scope);
+    interpreter->scope_allocations++;
+  }
+
+  scope->interpreter = interpreter;
+  interpreter->current_scope = scope;
 }
 
 void yuji_scope_pop(YujiInterpreter* interpreter) {
   YujiScope* old = interpreter->current_scope;
 
-  if (old) {
-    interpreter->current_scope = old->parent;
+  if (!old) {
+    return;
+  }
+
+  interpreter->current_scope = old->parent;
+
+  if (interpreter->scope_pool->size < YUJI_SCOPE_POOL_SIZE) {
+    scope_clear(old);
+    yuji_dyn_array_push(interpreter->scope_pool, old);
+  } else {
     yuji_scope_free(old);
   }
 }
 
+size_t yuji_scope_index_of(YujiScope* scope, const char* key) {
+  // most block scopes never declare anything, skip hashing for those
+  if (scope->size == 0) {
+    return (size_t) -1;
+  }
+
+  return (size_t)(uintptr_t)yuji_map_get(scope->env, key) - 1;
+}
+
+size_t yuji_scope_declare(YujiScope* scope, const char* key) {
+  size_t index = yuji_scope_index_of(scope, key);
+
+  if (index != (size_t) -1) {
+    return index;
+  }
+
+  if (scope->size == scope->capacity) {
+    scope->capacity = scope->capacity ? scope->capacity * 2 : 8;
+    scope->names = yuji_realloc(scope->names, sizeof(char*) * scope->capacity);
+    scope->values = yuji_realloc(scope->values, sizeof(YujiValue*) * scope->capacity);
+    scope->imported = yuji_realloc(scope->imported, sizeof(bool) * scope->capacity);
+  }
+
+  if (!scope->env) {
+    scope->env = yuji_map_init_symbols();
+  }
+
+  index = scope->size++;
+  scope->names[index] = key;
+  scope->values[index] = NULL;
+  scope->imported[index] = false;
+  yuji_map_set(scope->env, key, (void*)(uintptr_t)(index + 1));
+
+  return index;
+}
+
 YujiValue* yuji_scope_get(YujiScope* scope, const char* key) {
   for (YujiScope* s = scope; s; s = s->parent) {
-    YujiValue* val = yuji_map_get(s->env, key);
+    size_t index = yuji_scope_index_of(s, key);
 
-    if (val) {
-      val->refcount++;
+    if (index != (size_t) -1 && s->values[index]) {
+      YujiValue* val = s->values[index];
+      yuji_value_ref(val);
       return val;
     }
   }
@@ -63,24 +148,24 @@ YujiValue* yuji_scope_get(YujiScope* scope, const char* key) {
 }
 
 void yuji_scope_set(YujiScope* scope, const char* key, YujiValue* val) {
-  YujiValue* old_val = yuji_map_get(scope->env, key);
+  size_t index = yuji_scope_declare(scope, key);
+  YujiValue* old_val = scope->values[index];
+
+  yuji_value_ref(val);
+  scope->values[index] = val;
+  scope->imported[index] = false;
 
   if (old_val) {
     yuji_value_free(old_val);
   }
-
-  val->refcount++;
-  yuji_map_set(scope->env, key, val);
 }
 
 void yuji_scope_update(YujiScope* scope, const char* key, YujiValue* val) {
   for (YujiScope* s = scope; s; s = s->parent) {
-    YujiValue* existing = yuji_map_get(s->env, key);
+    size_t index = yuji_scope_index_of(s, key);
 
-    if (existing) {
-      yuji_value_free(existing);
-      val->refcount++;
-      yuji_map_set(s->env, key, val);
+    if (index != (size_t) -1 && s->values[index]) {
+      yuji_scope_set(s, key, val);
       return;
     }
   }
@@ -89,26 +174,37 @@ void yuji_scope_update(YujiScope* scope, const char* key, YujiValue* val) {
 }
 
 void yuji_scope_merge(YujiScope* dest, YujiScope* src) {
-  YUJI_DYN_ARRAY_ITER(src->env->pairs, YujiMapPair, pair, {
-    yuji_scope_set(dest, pair->key, pair->value);
-  })
+  for (size_t i = 0; i < src->size; i++) {
+    if (src->values[i]) {
+      yuji_scope_set(dest, src->names[i], src->values[i]);
+      dest->imported[yuji_scope_index_of(dest, src->names[i])] = true;
+    }
+  }
+}
+
+bool yuji_scope_defines(YujiScope* scope, const char* key) {
+  for (YujiScope* s = scope; s; s = s->parent) {
+    size_t index = yuji_scope_index_of(s, key);
+
+    if (index != (size_t) -1 && s->values[index]) {
+      return !s->imported[index];
+    }
+  }
+
+  return false;
 }
 
 YujiCallFrame* yuji_call_frame_init(YujiScope* scope, const char* name, YujiDynArray* args) {
   YujiCallFrame* frame = yuji_malloc(sizeof(YujiCallFrame));
 
   frame->scope = scope;
-  frame->function_name = strdup(name);
+  frame->function_name = name;
   frame->args = args;
-  frame->has_return = false;
-  frame->return_value = NULL;
 
   return frame;
 }
 
 void yuji_call_frame_free(YujiCallFrame* frame) {
-  yuji_free(frame->function_name);
-
   if (frame->args) {
     YUJI_DYN_ARRAY_ITER(frame->args, YujiValue, arg, {
       yuji_value_free(arg);
@@ -116,23 +212,6 @@ void yuji_call_frame_free(YujiCallFrame* frame) {
     yuji_dyn_array_free(frame->args);
   }
 
-  if (frame->return_value) {
-    yuji_value_free(frame->return_value);
-  }
-
-  yuji_free(frame);
-}
-
-YujiLoopFrame* yuji_loop_frame_init() {
-  YujiLoopFrame* frame = yuji_malloc(sizeof(YujiLoopFrame));
-
-  frame->has_break = false;
-  frame->has_continue = false;
-
-  return frame;
-}
-
-void yuji_loop_frame_free(YujiLoopFrame* frame) {
   yuji_free(frame);
 }
 
@@ -140,10 +219,16 @@ YujiInterpreter* yuji_interpreter_init() {
   YujiInterpreter* interpreter = yuji_malloc(sizeof(YujiInterpreter));
 
   interpreter->current_scope = yuji_scope_init(NULL);
+  interpreter->current_scope->interpreter = interpreter;
+  interpreter->scope_pool = yuji_dyn_array_init();
+  interpreter->scope_allocations = 0;
   interpreter->loaded_modules = yuji_map_init();
   interpreter->call_stack = yuji_stack_init();
-  interpreter->loop_stack = yuji_stack_init();
+  interpreter->flow = YUJI_FLOW_NORMAL;
+  interpreter->loop_depth = 0;
   interpreter->max_stack_size = 10000;
+  interpreter->backend = YUJI_BACKEND_VM;
+  interpreter->vm = yuji_vm_init(interpreter);
 
   yuji_std_load_all(interpreter);
 
@@ -151,20 +236,32 @@ YujiInterpreter* yuji_interpreter_init() {
 }
 
 void yuji_interpreter_free(YujiInterpreter* interpreter) {
+  yuji_vm_free(interpreter->vm);
+
   while (interpreter->current_scope) {
     yuji_scope_pop(interpreter);
   }
 
-  YUJI_DYN_ARRAY_ITER(interpreter->loaded_modules->pairs, YujiMapPair, pair, {
+  YUJI_DYN_ARRAY_ITER(interpreter->scope_pool, YujiScope, scope, {
+    yuji_scope_free(scope);
+  })
+  yuji_dyn_array_free(interpreter->scope_pool);
+
+  YUJI_MAP_ITER(interpreter->loaded_modules, pair, {
     yuji_module_free(pair->value);
   })
   yuji_map_free(interpreter->loaded_modules);
   yuji_stack_free(interpreter->call_stack);
-  yuji_stack_free(interpreter->loop_stack);
   yuji_free(interpreter);
 }
 
-void yuji_interpreter_load_module(YujiInterpreter* interpreter, const char* module_name) {
+void yuji_interpreter_print_stats(YujiInterpreter* interpreter, FILE* stream) {
+  fprintf(stream, "scopes:\n");
+  fprintf(stream, "  allocated %zu, pooled %zu\n", interpreter->scope_allocations,
+          interpreter->scope_pool->size);
+}
+
+YujiModule* yuji_interpreter_find_module(YujiInterpreter* interpreter, const char* module_name) {
   yuji_check_memory(interpreter);
 
   YujiString* name_str = yuji_string_init_from_cstr(module_name);
@@ -187,14 +284,15 @@ void yuji_interpreter_load_module(YujiInterpreter* interpreter, const char* modu
     module = yuji_map_get(interpreter->loaded_modules, root_name->data);
 
     if (!module) {
-      module = yuji_module_init(root_name->data);
+      module = yuji_module_init(yuji_symbol_intern(root_name->data));
       yuji_map_set(interpreter->loaded_modules, root_name->data, module);
 
       YujiASTNode* ast = yuji_get_ast_from_file(root_name->data);
       YujiScope* prev = interpreter->current_scope;
+      module->scope->interpreter = interpreter;
       interpreter->current_scope = module->scope;
 
-      YujiValue* result = yuji_interpreter_eval_module(interpreter, ast->value.module);
+      YujiValue* result = yuji_interpreter_run_module(interpreter, ast->value.module);
 
       interpreter->current_scope = prev;
       yuji_value_free(result);
@@ -207,7 +305,7 @@ void yuji_interpreter_load_module(YujiInterpreter* interpreter, const char* modu
       YujiModule* sub = yuji_module_find_submodule(module, part->data);
 
       if (!sub) {
-        sub = yuji_module_init(part->data);
+        sub = yuji_module_init(yuji_symbol_intern(part->data));
         yuji_module_add_submodule(module, sub);
       }
 
@@ -232,18 +330,129 @@ void yuji_interpreter_load_module(YujiInterpreter* interpreter, const char* modu
     }
   }
 
-  yuji_scope_merge(interpreter->current_scope, module->scope);
-
   YUJI_DYN_ARRAY_ITER(parts, YujiString, part, {
     yuji_string_free(part);
   })
 
   yuji_dyn_array_free(parts);
   yuji_string_free(name_str);
+
+  return module;
+}
+
+void yuji_interpreter_load_module(YujiInterpreter* interpreter, const char* module_name) {
+  YujiModule* module = yuji_interpreter_find_module(interpreter, module_name);
+  yuji_scope_merge(interpreter->current_scope, module->scope);
 }
 
 
 
+YujiValue* yuji_interpreter_run_module(YujiInterpreter* interpreter, YujiASTModule* module) {
+  yuji_check_memory(interpreter);
+
+  if (interpreter->backend == YUJI_BACKEND_VM) {
+    return yuji_vm_eval_module(interpreter->vm, module);
+  }
+
+  return yuji_interpreter_eval_module(interpreter, module);
+}
+
+// runs the body of a function whose arguments are bound in the scope pushed
+// for it, and pops that scope
+static YujiValue* interpreter_invoke(YujiInterpreter* interpreter, YujiASTFunction* fn_node,
+                                     const char* name) {
+  if (interpreter->call_stack->data->size > interpreter->max_stack_size) {
+    yuji_panic("stack overflow");
+  }
+
+  YujiCallFrame* frame = yuji_call_frame_init(interpreter->current_scope, name, NULL);
+  yuji_stack_push(interpreter->call_stack, frame);
+
+  // loops of the caller are out of reach of `break` and `continue` in here
+  size_t loop_depth = interpreter->loop_depth;
+  interpreter->loop_depth = 0;
+
+  // after a `return` the result already is the returned value
+  YujiValue* result = yuji_interpreter_eval(interpreter, fn_node->body);
+  interpreter->flow = YUJI_FLOW_NORMAL;
+  interpreter->loop_depth = loop_depth;
+
+  yuji_call_frame_free(yuji_stack_pop(interpreter->call_stack));
+  yuji_scope_pop(interpreter);
+
+  return result;
+}
+
+void yuji_callback_init(YujiCallback* callback, YujiInterpreter* interpreter, YujiValue* fn,
+                        size_t argc, const char* name) {
+  size_t expected;
+
+  switch (yuji_value_type(fn)) {
+    case VT_CFUNCTION:
+      expected = fn->value.cfunction->argc == YUJI_FN_INF_ARGUMENT ? argc : fn->value.cfunction->argc;
+      break;
+
+    case VT_FUNCTION:
+      expected = fn->value.function.proto ? fn->value.function.proto->params->size
+                                          : fn->value.function.node->params->size;
+      break;
+
+    default:
+      yuji_panic("'%s' is not a function (got '%s')", name, yuji_value_to_string(fn));
+  }
+
+  if (expected != argc) {
+    yuji_panic("function %s expects %zu args, got %zu", name, expected, argc);
+  }
+
+  callback->interpreter = interpreter;
+  callback->fn = fn;
+  callback->name = name;
+  callback->argc = argc;
+  callback->native_args = yuji_value_type(fn) == VT_CFUNCTION ? yuji_dyn_array_init() : NULL;
+}
+
+void yuji_callback_free(YujiCallback* callback) {
+  if (callback->native_args) {
+    yuji_dyn_array_free(callback->native_args);
+  }
+}
+
+YujiValue* yuji_callback_call(YujiCallback* callback) {
+  YujiInterpreter* interpreter = callback->interpreter;
+  YujiValue* fn = callback->fn;
+
+  if (callback->native_args) {
+    YujiDynArray* args = callback->native_args;
+    args->size = 0;
+
+    for (size_t i = 0; i < callback->argc; i++) {
+      yuji_dyn_array_push(args, callback->args[i]);
+    }
+
+    YujiCallFrame* frame = yuji_call_frame_init(interpreter->current_scope, callback->name, NULL);
+    yuji_stack_push(interpreter->call_stack, frame);
+
+    YujiValue* result = fn->value.cfunction->func(interpreter->current_scope, args);
+
+    yuji_call_frame_free(yuji_stack_pop(interpreter->call_stack));
+    return result;
+  }
+
+  if (fn->value.function.proto) {
+    return yuji_vm_call(interpreter->vm, fn, callback->args, callback->argc, callback->name);
+  }
+
+  YujiASTFunction* fn_node = fn->value.function.node;
+  yuji_scope_push(interpreter);
+
+  for (size_t i = 0; i < callback->argc; i++) {
+    yuji_scope_set(interpreter->current_scope, fn_node->params->data[i], callback->args[i]);
+  }
+
+  return interpreter_invoke(interpreter, fn_node, callback->name);
+}
+
 YujiValue* yuji_interpreter_eval_module(YujiInterpreter* interpreter, YujiASTModule* module) {
   yuji_check_memory(interpreter);
   yuji_check_memory(module);
@@ -273,20 +482,8 @@ YujiValue* yuji_interpreter_eval_block(YujiInterpreter* interpreter, YujiASTBloc
 
     result = expr_result;
 
-    if (interpreter->call_stack->data->size > 0) {
-      YujiCallFrame* frame = yuji_stack_peek(interpreter->call_stack);
-
-      if (frame->has_return) {
-        break;
-      }
-    }
-
-    if (interpreter->loop_stack->data->size > 0) {
-      YujiLoopFrame* lframe = yuji_stack_peek(interpreter->loop_stack);
-
-      if (lframe->has_break || lframe->has_continue) {
-        break;
-      }
+    if (interpreter->flow != YUJI_FLOW_NORMAL) {
+      break;
     }
   })
   yuji_scope_pop(interpreter);
@@ -319,53 +516,30 @@ YujiValue* yuji_interpreter_eval(YujiInterpreter* interpreter, YujiASTNode* node
     case YUJI_AST_BIN_OP: {
       YujiASTBinOp* binop = node->value.bin_op;
       YujiValue* left = yuji_interpreter_eval(interpreter, binop->left);
-      YujiValue* right = yuji_interpreter_eval(interpreter, binop->right);
-
-      bool is_float = (left->type == VT_FLOAT || right->type == VT_FLOAT);
-      double l = (left->type == VT_FLOAT) ? left->value.float_ : (double)left->value.int_;
-      double r = (right->type == VT_FLOAT) ? right->value.float_ : (double)right->value.int_;
 
-      YujiValue* result = NULL;
+      // the right operand of `&&` and `||` only runs if the left one does not
+      // decide the result
+      if (binop->operator == YUJI_OPERATOR_AND || binop->operator == YUJI_OPERATOR_OR) {
+        bool truthy = yuji_value_to_bool(left);
+        yuji_value_free(left);
 
-      if (YUJI_STRCMP(binop->operator, "+")) {
-        result = is_float ? yuji_value_float_init(l + r) : yuji_value_int_init((int64_t)(l + r));
-      } else if (YUJI_STRCMP(binop->operator, "-")) {
-        result = is_float ? yuji_value_float_init(l - r) : yuji_value_int_init((int64_t)(l - r));
-      } else if (YUJI_STRCMP(binop->operator, "*")) {
-        result = is_float ? yuji_value_float_init(l * r) : yuji_value_int_init((int64_t)(l * r));
-      } else if (YUJI_STRCMP(binop->operator, "/")) {
-        if (r == 0.0) {
-          yuji_panic("division by zero");
+        if (truthy == (binop->operator == YUJI_OPERATOR_OR)) {
+          return yuji_value_bool_init(truthy);
         }
 
-        result = is_float ? yuji_value_float_init(l / r) : yuji_value_int_init((int64_t)(l / r));
-      } else if (YUJI_STRCMP(binop->operator, "%")) {
-        result = yuji_value_int_init((int64_t)l % (int64_t)r);
-      } else if (YUJI_STRCMP(binop->operator, "<")) {
-        result = yuji_value_bool_init(l < r);
-      } else if (YUJI_STRCMP(binop->operator, ">")) {
-        result = yuji_value_bool_init(l > r);
-      } else if (YUJI_STRCMP(binop->operator, "==")) {
-        result = yuji_value_bool_init(l == r);
-      } else if (YUJI_STRCMP(binop->operator, "!=")) {
-        result = yuji_value_bool_init(l != r);
-      } else if (YUJI_STRCMP(binop->operator, "<=")) {
-        result = yuji_value_bool_init(l <= r);
-      } else if (YUJI_STRCMP(binop->operator, ">=")) {
-        result = yuji_value_bool_init(l >= r);
-      } else if (YUJI_STRCMP(binop->operator, "&&")) {
-        result = yuji_value_bool_init(yuji_value_to_bool(left) && yuji_value_to_bool(right));
-      } else if (YUJI_STRCMP(binop->operator, "||")) {
-        result = yuji_value_bool_init(yuji_value_to_bool(left) || yuji_value_to_bool(right));
+        YujiValue* right = yuji_interpreter_eval(interpreter, binop->right);
+        truthy = yuji_value_to_bool(right);
+        yuji_value_free(right);
+        return yuji_value_bool_init(truthy);
       }
 
+      YujiValue* right = yuji_interpreter_eval(interpreter, binop->right);
+
+      YujiValue* result = yuji_operator_eval(binop->operator, left, right);
+
       yuji_value_free(left);
       yuji_value_free(right);
 
-      if (result == NULL) {
-        yuji_panic("unhandled operator");
-      }
-
       return result;
     }
 
@@ -384,7 +558,7 @@ YujiValue* yuji_interpreter_eval(YujiInterpreter* interpreter, YujiASTNode* node
     case YUJI_AST_LET: {
       char* name = node->value.let->name;
 
-      if (yuji_scope_get(interpreter->current_scope, name)) {
+      if (yuji_scope_defines(interpreter->current_scope, name)) {
         yuji_panic("variable %s already exists", name);
       }
 
@@ -415,7 +589,34 @@ YujiValue* yuji_interpreter_eval(YujiInterpreter* interpreter, YujiASTNode* node
 
       yuji_value_free(existing);
 
-      YujiValue* value = yuji_interpreter_eval(interpreter, node->value.assign->value);
+      YujiASTNode* value_node = node->value.assign->value;
+      YujiValue* value;
+
+      // `name = name + ...` lends the variable's reference to the operator, so
+      // a string only the variable holds is extended in place
+      if (value_node->type == YUJI_AST_BIN_OP &&
+          value_node->value.bin_op->operator == YUJI_OPERATOR_ADD &&
+          value_node->value.bin_op->left->type == YUJI_AST_IDENTIFIER &&
+          value_node->value.bin_op->left->value.identifier->value == name) {
+        YujiValue* left = yuji_interpreter_eval(interpreter, value_node->value.bin_op->left);
+        YujiValue* right = yuji_interpreter_eval(interpreter, value_node->value.bin_op->right);
+        YujiValue* current = yuji_scope_get(interpreter->current_scope, name);
+
+        // only the pointer is compared, the variable keeps it alive
+        if (current) {
+          yuji_value_free(current);
+        }
+
+        value = current == left
+                ? yuji_operator_eval_update(YUJI_OPERATOR_ADD, left, right)
+                : yuji_operator_eval(YUJI_OPERATOR_ADD, left, right);
+
+        yuji_value_free(left);
+        yuji_value_free(right);
+      } else {
+        value = yuji_interpreter_eval(interpreter, value_node);
+      }
+
       yuji_scope_update(interpreter->current_scope, name, value);
       yuji_value_free(value);
       return yuji_value_null_init();
@@ -426,12 +627,12 @@ YujiValue* yuji_interpreter_eval(YujiInterpreter* interpreter, YujiASTNode* node
 
       if (!name) {
         YujiValue* value = yuji_value_function_init(node->value.fn);
-        value->refcount++;
+        yuji_value_ref(value);
         yuji_value_free(value);
         return value;
       }
 
-      if (yuji_scope_get(interpreter->current_scope, name)) {
+      if (yuji_scope_defines(interpreter->current_scope, name)) {
         yuji_panic("function %s already exists", name);
       }
 
@@ -451,7 +652,7 @@ YujiValue* yuji_interpreter_eval(YujiInterpreter* interpreter, YujiASTNode* node
 
       YujiValue* result = NULL;
 
-      if (fn->type == VT_CFUNCTION) {
+      if (yuji_value_type(fn) == VT_CFUNCTION) {
         if (fn->value.cfunction->argc != YUJI_FN_INF_ARGUMENT
             && fn->value.cfunction->argc != call->args->size) {
           yuji_panic("function '%s' expects %ld, got %ld", call->name, fn->value.cfunction->argc,
@@ -464,15 +665,13 @@ YujiValue* yuji_interpreter_eval(YujiInterpreter* interpreter, YujiASTNode* node
           yuji_dyn_array_push(args, arg_val);
         })
 
-        yuji_scope_push(interpreter);
         YujiCallFrame* frame = yuji_call_frame_init(interpreter->current_scope, call->name, args);
         yuji_stack_push(interpreter->call_stack, frame);
 
         result = fn->value.cfunction->func(interpreter->current_scope, args);
 
         yuji_call_frame_free(yuji_stack_pop(interpreter->call_stack));
-        yuji_scope_pop(interpreter);
-      } else if (fn->type == VT_FUNCTION) {
+      } else if (yuji_value_type(fn) == VT_FUNCTION) {
         YujiASTFunction* fn_node = fn->value.function.node;
 
         if (fn_node->params->size != call->args->size) {
@@ -493,30 +692,10 @@ YujiValue* yuji_interpreter_eval(YujiInterpreter* interpreter, YujiASTNode* node
           yuji_value_free(arg_val);
         }
 
-        if (interpreter->call_stack->data->size > interpreter->max_stack_size) {
-          yuji_panic("stack overflow");
-        }
-
-        YujiCallFrame* frame = yuji_call_frame_init(fn_scope, call->name, NULL);
-        yuji_stack_push(interpreter->call_stack, frame);
-
-        result = yuji_interpreter_eval(interpreter, fn_node->body);
-
-        YujiValue* ret_val;
-
-        if (frame->has_return) {
-          ret_val = frame->return_value ? frame->return_value : yuji_value_null_init();
-          frame->return_value = NULL;
-          yuji_value_free(result);
-        } else {
-          ret_val = result;
-        }
-
-        yuji_call_frame_free(yuji_stack_pop(interpreter->call_stack));
-        yuji_scope_pop(interpreter);
+        result = interpreter_invoke(interpreter, fn_node, call->name);
         yuji_value_free(fn);
 
-        return ret_val;
+        return result;
       } else {
         yuji_panic("'%s' is not a function (got '%s')", call->name, yuji_value_to_string(fn));
       }
@@ -527,8 +706,7 @@ YujiValue* yuji_interpreter_eval(YujiInterpreter* interpreter, YujiASTNode* node
 
     case YUJI_AST_WHILE: {
       yuji_scope_push(interpreter);
-      YujiLoopFrame* loop_frame = yuji_loop_frame_init();
-      yuji_stack_push(interpreter->loop_stack, loop_frame);
+      interpreter->loop_depth++;
 
       YujiValue* result = yuji_value_null_init();
 
@@ -537,19 +715,24 @@ YujiValue* yuji_interpreter_eval(YujiInterpreter* interpreter, YujiASTNode* node
         bool cond = yuji_value_to_bool(condition_val);
         yuji_value_free(condition_val);
 
-        if (!cond || loop_frame->has_break) {
+        if (!cond) {
           break;
         }
 
-        if (loop_frame->has_continue) {
-          loop_frame->has_continue = false;
-        }
-
         yuji_value_free(result);
         result = yuji_interpreter_eval_block(interpreter, node->value.while_stmt->body);
+
+        if (interpreter->flow == YUJI_FLOW_CONTINUE) {
+          interpreter->flow = YUJI_FLOW_NORMAL;
+        } else if (interpreter->flow == YUJI_FLOW_BREAK) {
+          interpreter->flow = YUJI_FLOW_NORMAL;
+          break;
+        } else if (interpreter->flow == YUJI_FLOW_RETURN) {
+          break;
+        }
       }
 
-      yuji_loop_frame_free(yuji_stack_pop(interpreter->loop_stack));
+      interpreter->loop_depth--;
       yuji_scope_pop(interpreter);
       return result;
     }
@@ -585,39 +768,34 @@ YujiValue* yuji_interpreter_eval(YujiInterpreter* interpreter, YujiASTNode* node
       YujiValue* value = node->value.return_stmt->value
                          ? yuji_interpreter_eval(interpreter, node->value.return_stmt->value)
                          : yuji_value_null_init();
-      YujiCallFrame* frame = yuji_stack_peek(interpreter->call_stack);
-      frame->has_return = true;
-      value->refcount++;
-      frame->return_value = value;
+      interpreter->flow = YUJI_FLOW_RETURN;
       return value;
     }
 
     case YUJI_AST_BREAK: {
-      if (interpreter->loop_stack->data->size == 0) {
+      if (interpreter->loop_depth == 0) {
         yuji_panic("Cannot break outside of a loop");
       }
 
-      YujiLoopFrame* frame = yuji_stack_peek(interpreter->loop_stack);
-      frame->has_break = true;
+      interpreter->flow = YUJI_FLOW_BREAK;
       return yuji_value_null_init();
     }
 
     case YUJI_AST_CONTINUE: {
-      if (interpreter->loop_stack->data->size == 0) {
+      if (interpreter->loop_depth == 0) {
         yuji_panic("Cannot continue outside of a loop");
       }
 
-      YujiLoopFrame* frame = yuji_stack_peek(interpreter->loop_stack);
-      frame->has_continue = true;
+      interpreter->flow = YUJI_FLOW_CONTINUE;
       return yuji_value_null_init();
     }
 
     case YUJI_AST_ARRAY: {
-      YujiDynArray* evaluated_elements = yuji_dyn_array_init();
+      YujiArray* evaluated_elements = yuji_array_init(node->value.array->elements->size);
 
       YUJI_DYN_ARRAY_ITER(node->value.array->elements, YujiASTNode, element, {
         YujiValue* evaluated = yuji_interpreter_eval(interpreter, element);
-        yuji_dyn_array_push(evaluated_elements, evaluated);
+        yuji_array_push(evaluated_elements, evaluated);
       })
 
       return yuji_value_array_init(evaluated_elements);
@@ -627,15 +805,15 @@ YujiValue* yuji_interpreter_eval(YujiInterpreter* interpreter, YujiASTNode* node
       YujiValue* obj_val = yuji_interpreter_eval(interpreter, node->value.index_access->object);
       YujiValue* index_val = yuji_interpreter_eval(interpreter, node->value.index_access->index);
 
-      if (obj_val->type != VT_ARRAY) {
+      if (yuji_value_type(obj_val) != VT_ARRAY) {
         yuji_panic("Cannot index non-array type");
       }
 
-      if (index_val->type != VT_INT) {
+      if (yuji_value_type(index_val) != VT_INT) {
         yuji_panic("Array index must be an integer");
       }
 
-      int64_t index = index_val->value.int_;
+      int64_t index = yuji_value_as_int(index_val);
       yuji_value_free(index_val);
 
       if (index < 0 || (size_t)index >= obj_val->value.array->size) {
@@ -643,8 +821,7 @@ YujiValue* yuji_interpreter_eval(YujiInterpreter* interpreter, YujiASTNode* node
         yuji_panic("Array index out of bounds: %lld", (long long)index);
       }
 
-      YujiValue* element = yuji_dyn_array_get(obj_val->value.array, (size_t)index);
-      element->refcount++;
+      YujiValue* element = yuji_array_get(obj_val->value.array, (size_t)index);
       yuji_value_free(obj_val);
       return element;
     }
@@ -654,15 +831,15 @@ YujiValue* yuji_interpreter_eval(YujiInterpreter* interpreter, YujiASTNode* node
       YujiValue* index_val = yuji_interpreter_eval(interpreter, node->value.index_assign->index);
       YujiValue* new_value = yuji_interpreter_eval(interpreter, node->value.index_assign->value);
 
-      if (obj_val->type != VT_ARRAY) {
+      if (yuji_value_type(obj_val) != VT_ARRAY) {
         yuji_panic("Cannot index non-array type");
       }
 
-      if (index_val->type != VT_INT) {
+      if (yuji_value_type(index_val) != VT_INT) {
         yuji_panic("Array index must be an integer");
       }
 
-      int64_t index = index_val->value.int_;
+      int64_t index = yuji_value_as_int(index_val);
       yuji_value_free(index_val);
 
       if (index < 0 || (size_t)index >= obj_val->value.array->size) {
@@ -671,14 +848,8 @@ YujiValue* yuji_interpreter_eval(YujiInterpreter* interpreter, YujiASTNode* node
         yuji_panic("Array index out of bounds: %lld", (long long)index);
       }
 
-      YujiValue* old_element = yuji_dyn_array_get(obj_val->value.array, (size_t)index);
-      yuji_value_free(old_element);
-
-      new_value->refcount++;
-      yuji_dyn_array_set(obj_val->value.array, (size_t)index, new_value);
-
+      yuji_array_set(obj_val->value.array, (size_t)index, new_value);
       yuji_value_free(obj_val);
-      yuji_value_free(new_value);
 
       return yuji_value_null_init();
     }
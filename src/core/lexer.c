@@ -2,20 +2,19 @@
 #include "yuji/core/memory.h"
 #include "yuji/core/position.h"
 #include "yuji/core/token.h"
-#include "yuji/core/types/dyn_array.h"
-#include "yuji/core/types/string.h"
 #include "yuji/utils.h"
 #include <ctype.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 
-YujiLexer* yuji_lexer_init(YujiDynArray* input, const char* file_name) {
+YujiLexer* yuji_lexer_init(const char* source, size_t length, const char* file_name) {
   YujiLexer* lexer = yuji_malloc(sizeof(YujiLexer));
 
-  lexer->input = input;
+  lexer->source = source;
+  lexer->current = source;
+  lexer->end = source + length;
   lexer->position = yuji_position_init(0, 0, file_name);
-  lexer->current_char = yuji_lexer_peek(lexer);
 
   return lexer;
 }
@@ -25,86 +24,60 @@ void yuji_lexer_free(YujiLexer* lexer) {
 }
 
 char yuji_lexer_peek(YujiLexer* lexer) {
-  if (lexer->position.line >= lexer->input->size) {
-    return '\0';
-  }
-
-  char* line = yuji_dyn_array_get(lexer->input, lexer->position.line);
-
-  if (!line || lexer->position.column >= strlen(line)) {
-    return '\0';
-  }
-
-  return line[lexer->position.column];
+  return lexer->current < lexer->end ? *lexer->current : '\0';
 }
 
 char yuji_lexer_peek_next(YujiLexer* lexer) {
-  if (lexer->position.line >= lexer->input->size) {
-    return '\0';
-  }
-
-  char* line = yuji_dyn_array_get(lexer->input, lexer->position.line);
-
-  if (!line || lexer->position.column >= strlen(line)) {
-    return '\0';
-  }
-
-  return line[lexer->position.column + 1];
+  return lexer->current + 1 < lexer->end ? lexer->current[1] : '\0';
 }
 
 char yuji_lexer_advance(YujiLexer* lexer) {
-  if (lexer->position.line >= lexer->input->size) {
-    lexer->current_char = '\0';
+  if (lexer->current >= lexer->end) {
     return '\0';
   }
 
-  char* line = yuji_dyn_array_get(lexer->input, lexer->position.line);
-
-  if (!line || lexer->position.column >= strlen(line)) {
+  if (*lexer->current == '\n') {
     lexer->position.line++;
     lexer->position.column = 0;
-
-    if (lexer->position.line >= lexer->input->size) {
-      lexer->current_char = '\0';
-      return '\0';
-    }
-
-    line = yuji_dyn_array_get(lexer->input, lexer->position.line);
-
-    if (!line || line[0] == '\0') {
-      lexer->current_char = '\0';
-      return '\0';
-    }
-
-    lexer->current_char = line[0];
   } else {
     lexer->position.column++;
+  }
 
-    if (lexer->position.column < strlen(line)) {
-      lexer->current_char = line[lexer->position.column];
-    } else {
-      lexer->position.line++;
-      lexer->position.column = 0;
-
-      if (lexer->position.line >= lexer->input->size) {
-        lexer->current_char = '\0';
-        return '\0';
-      }
+  lexer->current++;
+  return yuji_lexer_peek(lexer);
+}
 
-      line = yuji_dyn_array_get(lexer->input, lexer->position.line);
-      lexer->current_char = (line && line[0] != '\0') ? line[0] : '\0';
-    }
+static YujiTokenType keyword_type(const char* start, size_t length) {
+#define _YUJI_LEXER_KEYWORD_CASE(KEYWORD, TYPE) \
+  if (length == sizeof(KEYWORD) - 1 && memcmp(start, KEYWORD, length) == 0) { \
+    return TYPE; \
   }
 
-  return lexer->current_char;
+  _YUJI_LEXER_KEYWORD_CASE("let", TT_LET)
+  _YUJI_LEXER_KEYWORD_CASE("if", TT_IF)
+  _YUJI_LEXER_KEYWORD_CASE("elif", TT_ELIF)
+  _YUJI_LEXER_KEYWORD_CASE("else", TT_ELSE)
+  _YUJI_LEXER_KEYWORD_CASE("fn", TT_FN)
+  _YUJI_LEXER_KEYWORD_CASE("use", TT_USE)
+  _YUJI_LEXER_KEYWORD_CASE("true", TT_BOOL)
+  _YUJI_LEXER_KEYWORD_CASE("false", TT_BOOL)
+  _YUJI_LEXER_KEYWORD_CASE("null", TT_NULL)
+  _YUJI_LEXER_KEYWORD_CASE("while", TT_WHILE)
+  _YUJI_LEXER_KEYWORD_CASE("return", TT_RETURN)
+  _YUJI_LEXER_KEYWORD_CASE("break", TT_BREAK)
+  _YUJI_LEXER_KEYWORD_CASE("continue", TT_CONTINUE)
+
+#undef _YUJI_LEXER_KEYWORD_CASE
+
+  return TT_IDENTIFIER;
 }
 
-bool yuji_lexer_tokenize(YujiLexer* lexer, YujiDynArray* tokens) {
+bool yuji_lexer_tokenize(YujiLexer* lexer, YujiTokenArray* tokens) {
   yuji_check_memory(lexer);
   yuji_check_memory(tokens);
 
-  while (lexer->current_char != '\0') {
-    char c = lexer->current_char;
+  while (lexer->current < lexer->end) {
+    char c = *lexer->current;
 
     if (isspace(c)) {
       yuji_lexer_skip_whitespace(lexer);
@@ -114,7 +87,7 @@ bool yuji_lexer_tokenize(YujiLexer* lexer, YujiDynArray* tokens) {
     YUJI_LOG("current char: %c", c);
 
     if (c == '/' && yuji_lexer_peek_next(lexer) == '/') {
-      while (lexer->current_char != '\0' && lexer->current_char != '\n') {
+      while (lexer->current < lexer->end && *lexer->current != '\n') {
         yuji_lexer_advance(lexer);
       }
 
@@ -122,99 +95,62 @@ bool yuji_lexer_tokenize(YujiLexer* lexer, YujiDynArray* tokens) {
     }
 
     YujiTokenType type;
-    char* value;
+    YujiPosition position = lexer->position;
+    const char* start = lexer->current;
 
     if (isalpha(c)) {
-      value = yuji_lexer_parse_identifier_or_keyword(lexer);
-
-      if (strcmp(value, "let") == 0) {
-        type = TT_LET;
-      } else if (strcmp(value, "if") == 0) {
-        type = TT_IF;
-      } else if (strcmp(value, "elif") == 0) {
-        type = TT_ELIF;
-      } else if (strcmp(value, "else") == 0) {
-        type = TT_ELSE;
-      } else if (strcmp(value, "fn") == 0) {
-        type = TT_FN;
-      } else if (strcmp(value, "use") == 0) {
-        type = TT_USE;
-      } else if (strcmp(value, "true") == 0 || strcmp(value, "false") == 0) {
-        type = TT_BOOL;
-      } else if (strcmp(value, "null") == 0) {
-        type = TT_NULL;
-      } else if (strcmp(value, "while") == 0) {
-        type = TT_WHILE;
-      } else if (strcmp(value, "return") == 0) {
-        type = TT_RETURN;
-      } else if (strcmp(value, "break") == 0) {
-        type = TT_BREAK;
-      } else if (strcmp(value, "continue") == 0) {
-        type = TT_CONTINUE;
-      } else {
-        type = TT_IDENTIFIER;
-      }
+      yuji_lexer_scan_identifier_or_keyword(lexer);
+      type = keyword_type(start, (size_t)(lexer->current - start));
     } else if (c == '"') {
-      value = yuji_lexer_parse_string(lexer);
+      yuji_lexer_scan_string(lexer);
       type = TT_STRING;
     } else if (isdigit(c)) {
-      value = yuji_lexer_parse_number(lexer);
+      yuji_lexer_scan_number(lexer);
       type = TT_NUMBER;
     } else {
 
       if (c == '=' && yuji_lexer_peek_next(lexer) == '=') {
         type = TT_EQ;
-        value = strdup("==");
         yuji_lexer_advance(lexer);
         yuji_lexer_advance(lexer);
       } else if (c == '!' && yuji_lexer_peek_next(lexer) == '=') {
         type = TT_NEQ;
-        value = strdup("!=");
         yuji_lexer_advance(lexer);
         yuji_lexer_advance(lexer);
       } else if (c == '>' && yuji_lexer_peek_next(lexer) == '=') {
         type = TT_GTE;
-        value = strdup(">=");
         yuji_lexer_advance(lexer);
         yuji_lexer_advance(lexer);
       } else if (c == '<' && yuji_lexer_peek_next(lexer) == '=') {
         type = TT_LTE;
-        value = strdup("<=");
         yuji_lexer_advance(lexer);
         yuji_lexer_advance(lexer);
       } else if (c == '&' && yuji_lexer_peek_next(lexer) == '&') {
         type = TT_AND;
-        value = strdup("&&");
         yuji_lexer_advance(lexer);
         yuji_lexer_advance(lexer);
       } else if (c == '|' && yuji_lexer_peek_next(lexer) == '|') {
         type = TT_OR;
-        value = strdup("||");
         yuji_lexer_advance(lexer);
         yuji_lexer_advance(lexer);
       } else if (c == '+' && yuji_lexer_peek_next(lexer) == '=') {
         type = TT_PLUS_ASSIGN;
-        value = strdup("+=");
         yuji_lexer_advance(lexer);
         yuji_lexer_advance(lexer);
       } else if (c == '-' && yuji_lexer_peek_next(lexer) == '=') {
         type = TT_MINUS_ASSIGN;
-        value = strdup("-=");
         yuji_lexer_advance(lexer);
         yuji_lexer_advance(lexer);
       } else if (c == '*' && yuji_lexer_peek_next(lexer) == '=') {
         type = TT_MUL_ASSIGN;
-        value = strdup("*=");
         yuji_lexer_advance(lexer);
         yuji_lexer_advance(lexer);
       } else if (c == '/' && yuji_lexer_peek_next(lexer) == '=') {
         type = TT_DIV_ASSIGN;
-        value = strdup("/=");
         yuji_lexer_advance(lexer);
         yuji_lexer_advance(lexer);
       } else if (c == '%' && yuji_lexer_peek_next(lexer) == '=') {
         type = TT_MOD_ASSIGN;
-        value = strdup("%=");
         yuji_lexer_advance(lexer);
         yuji_lexer_advance(lexer);
       } else {
@@ -239,45 +175,46 @@ bool yuji_lexer_tokenize(YujiLexer* lexer, YujiDynArray* tokens) {
 
           default:
             yuji_panic("lexer error: unknown operator '%c' (%d) at %s", c, c,
-                       yuji_position_to_string(lexer->position));
+                       yuji_position_to_string(position));
         }
 
 #undef _YUJI_LEXER_OPERATOR_CASE
 
-        value = yuji_malloc(2);
-        value[0] = c;
-        value[1] = '\0';
         yuji_lexer_advance(lexer);
       }
     }
 
-    YUJI_LOG("VALUE: %s", value)
-    yuji_dyn_array_push(tokens, yuji_token_init(value, type, lexer->position));
+    YujiToken token = {
+      .start = start,
+      .length = (size_t)(lexer->current - start),
+      .type = type,
+      .position = position,
+    };
+
+    // the view excludes the quotes
+    if (type == TT_STRING) {
+      token.start++;
+      token.length -= 2;
+    }
+
+    YUJI_LOG("VALUE: %.*s", (int)token.length, token.start)
+    yuji_token_array_push(tokens, token);
   }
 
   return true;
 }
 
-void yuji_lexer_skip_whitespace(YujiLexer * lexer) {
-  while (lexer->current_char != '\0' && isspace(lexer->current_char)) {
-    if (lexer->current_char == '\n') {
-      lexer->position.line++;
-      lexer->position.column = 0;
-    } else {
-      lexer->position.column++;
-    }
-
-    lexer->current_char = yuji_lexer_peek(lexer);
+void yuji_lexer_skip_whitespace(YujiLexer* lexer) {
+  while (lexer->current < lexer->end && isspace(*lexer->current)) {
+    yuji_lexer_advance(lexer);
   }
 }
 
-char* yuji_lexer_parse_number(YujiLexer * lexer) {
-  YujiString* str = yuji_string_init();
-  char c = lexer->current_char;
-
+void yuji_lexer_scan_number(YujiLexer* lexer) {
+  char c = yuji_lexer_peek(lexer);
   size_t dot_count = 0;
 
-  while (c != '\0' && (isdigit(c) || c == '.')) {
+  while (isdigit(c) || c == '.') {
     if (c == '.') {
       dot_count++;
 
@@ -286,78 +223,43 @@ char* yuji_lexer_parse_number(YujiLexer * lexer) {
       }
     }
 
-    yuji_string_append_char(str, c);
     c = yuji_lexer_advance(lexer);
   }
-
-  char* result = strdup(str->data);
-  yuji_string_free(str);
-
-  return result;
 }
 
-char* yuji_lexer_parse_string(YujiLexer * lexer) {
-  YujiString* str = yuji_string_init();
+// only validates escape sequences, the parser decodes them
+void yuji_lexer_scan_string(YujiLexer* lexer) {
   char c = yuji_lexer_advance(lexer);
 
-  while (c != '\0' && c != '"') {
+  while (lexer->current < lexer->end && c != '"') {
     if (c == '\\') {
-      c = yuji_lexer_advance(lexer);
-
-      if (c == '\0') {
-        yuji_panic("lexer error: unexpected end of string at %s", yuji_position_to_string(lexer->position));
+      if (lexer->current + 1 >= lexer->end) {
+        yuji_panic("lexer error: unexpected end of string at %s",
+                   yuji_position_to_string(lexer->position));
       }
 
-      switch (c) {
-        case 'n':
-          yuji_string_append_char(str, '\n');
-          break;
-
-        case 't':
-          yuji_string_append_char(str, '\t');
-          break;
-
-        case '"':
-          yuji_string_append_char(str, '"');
-          break;
-
-        case '\\':
-          yuji_string_append_char(str, '\\');
-          break;
+      c = yuji_lexer_advance(lexer);
 
-        default:
-          yuji_panic("lexer error: invalid escape sequence at %s", yuji_position_to_string(lexer->position));
+      if (c != 'n' && c != 't' && c != '"' && c != '\\') {
+        yuji_panic("lexer error: invalid escape sequence at %s",
+                   yuji_position_to_string(lexer->position));
       }
-    } else {
-      yuji_string_append_char(str, c);
     }
 
     c = yuji_lexer_advance(lexer);
   }
 
-  if (c != '"') {
+  if (lexer->current >= lexer->end) {
     yuji_panic("lexer error: unterminated string at %s", yuji_position_to_string(lexer->position));
   }
 
   yuji_lexer_advance(lexer);
-
-  char* result = strdup(str->data);
-  yuji_string_free(str);
-
-  return result;
 }
 
-char* yuji_lexer_parse_identifier_or_keyword(YujiLexer * lexer) {
-  YujiString* str = yuji_string_init();
-  char c = lexer->current_char;
+void yuji_lexer_scan_identifier_or_keyword(YujiLexer* lexer) {
+  char c = yuji_lexer_peek(lexer);
 
-  while (c != '\0' && (isalpha(c) || isdigit(c) || c == '_')) {
-    yuji_string_append_char(str, c);
+  while (isalpha(c) || isdigit(c) || c == '_') {
     c = yuji_lexer_advance(lexer);
   }
-
-  char* result = strdup(str->data);
-  yuji_string_free(str);
-
-  return result;
 }
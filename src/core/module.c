@@ -1,5 +1,6 @@
 #include "yuji/core/interpreter.h"
 #include "yuji/core/memory.h"
+#include "yuji/core/symbol.h"
 #include "yuji/core/types/dyn_array.h"
 #include "yuji/core/types/map.h"
 #include <yuji/core/module.h>
@@ -15,7 +16,7 @@ YujiModule* yuji_module_init(const char* name) {
 }
 
 void yuji_module_free(YujiModule* module) {
-  YUJI_DYN_ARRAY_ITER(module->submodules->pairs, YujiMapPair, pair, {
+  YUJI_MAP_ITER(module->submodules, pair, {
     yuji_module_free(pair->value);
   })
 
@@ -29,6 +30,8 @@ void yuji_module_add_submodule(YujiModule* module, YujiModule* submodule) {
 }
 
 void yuji_module_register(YujiModule* module, const char* name, YujiValue* value) {
+  name = yuji_symbol_intern(name);
+
   if (yuji_scope_get(module->scope, name)) {
     yuji_panic("names %s already exists in module '%s'", name, module->name);
   }
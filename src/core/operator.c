@@ -0,0 +1,396 @@
+#include "yuji/core/operator.h"
+#include "yuji/core/memory.h"
+#include "yuji/core/value.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+
+// operands are classified into a handful of kinds and every operator has one
+// kernel per (left, right) pair of kinds. a missing kernel falls back to the
+// generic path in yuji_operator_eval
+typedef enum {
+  YUJI_OPERAND_OTHER,
+  YUJI_OPERAND_INT,
+  YUJI_OPERAND_FLOAT,
+  YUJI_OPERAND_STRING,
+} YujiOperandKind;
+
+#define YUJI_OPERAND_KINDS (YUJI_OPERAND_STRING + 1)
+#define YUJI_OPERAND_PAIR(LEFT, RIGHT) ((LEFT) * YUJI_OPERAND_KINDS + (RIGHT))
+#define YUJI_OPERAND_PAIRS (YUJI_OPERAND_KINDS * YUJI_OPERAND_KINDS)
+
+typedef YujiValue* (*YujiOperatorKernel)(YujiValue* left, YujiValue* right);
+
+static const YujiOperandKind operand_kinds[] = {
+  [VT_INT] = YUJI_OPERAND_INT,
+  [VT_FLOAT] = YUJI_OPERAND_FLOAT,
+  [VT_FUNCTION] = YUJI_OPERAND_OTHER,
+  [VT_CFUNCTION] = YUJI_OPERAND_OTHER,
+  [VT_STRING] = YUJI_OPERAND_STRING,
+  [VT_NULL] = YUJI_OPERAND_OTHER,
+  [VT_BOOL] = YUJI_OPERAND_OTHER,
+  [VT_ARRAY] = YUJI_OPERAND_OTHER,
+};
+
+const char* yuji_operator_to_string(YujiOperator op) {
+  switch (op) {
+    case YUJI_OPERATOR_ADD:
+      return "+";
+
+    case YUJI_OPERATOR_SUB:
+      return "-";
+
+    case YUJI_OPERATOR_MUL:
+      return "*";
+
+    case YUJI_OPERATOR_DIV:
+      return "/";
+
+    case YUJI_OPERATOR_MOD:
+      return "%";
+
+    case YUJI_OPERATOR_LT:
+      return "<";
+
+    case YUJI_OPERATOR_GT:
+      return ">";
+
+    case YUJI_OPERATOR_LTE:
+      return "<=";
+
+    case YUJI_OPERATOR_GTE:
+      return ">=";
+
+    case YUJI_OPERATOR_EQ:
+      return "==";
+
+    case YUJI_OPERATOR_NEQ:
+      return "!=";
+
+    case YUJI_OPERATOR_AND:
+      return "&&";
+
+    case YUJI_OPERATOR_OR:
+      return "||";
+  }
+
+  yuji_panic("Unknown operator: %d", op);
+}
+
+YujiOperator yuji_operator_from_token(YujiTokenType type) {
+  switch (type) {
+    case TT_PLUS:
+    case TT_PLUS_ASSIGN:
+      return YUJI_OPERATOR_ADD;
+
+    case TT_MINUS:
+    case TT_MINUS_ASSIGN:
+      return YUJI_OPERATOR_SUB;
+
+    case TT_MUL:
+    case TT_MUL_ASSIGN:
+      return YUJI_OPERATOR_MUL;
+
+    case TT_DIV:
+    case TT_DIV_ASSIGN:
+      return YUJI_OPERATOR_DIV;
+
+    case TT_MOD:
+    case TT_MOD_ASSIGN:
+      return YUJI_OPERATOR_MOD;
+
+    case TT_LT:
+      return YUJI_OPERATOR_LT;
+
+    case TT_GT:
+      return YUJI_OPERATOR_GT;
+
+    case TT_LTE:
+      return YUJI_OPERATOR_LTE;
+
+    case TT_GTE:
+      return YUJI_OPERATOR_GTE;
+
+    case TT_EQ:
+      return YUJI_OPERATOR_EQ;
+
+    case TT_NEQ:
+      return YUJI_OPERATOR_NEQ;
+
+    case TT_AND:
+      return YUJI_OPERATOR_AND;
+
+    case TT_OR:
+      return YUJI_OPERATOR_OR;
+
+    default:
+      break;
+  }
+
+  yuji_panic("Token %s is not an operator", yuji_token_type_to_string(type));
+}
+
+// numeric kernels. int x int stays in int64 and panics on overflow instead of
+// wrapping, the result is a float as soon as one of the operands is a float
+
+#define _YUJI_ARITH_KERNELS(NAME, BUILTIN, EXPR) \
+  static YujiValue* NAME##_int_int(YujiValue* left, YujiValue* right) { \
+    int64_t result; \
+    if (BUILTIN(yuji_value_as_int(left), yuji_value_as_int(right), &result)) { \
+      yuji_panic("integer overflow in %" PRId64 " %s %" PRId64, yuji_value_as_int(left), #EXPR, \
+                 yuji_value_as_int(right)); \
+    } \
+    return yuji_value_int_init(result); \
+  } \
+  _YUJI_FLOAT_KERNELS(NAME, l EXPR r)
+
+#define _YUJI_FLOAT_KERNELS(NAME, EXPR) \
+  static YujiValue* NAME##_int_float(YujiValue* left, YujiValue* right) { \
+    double l = (double)yuji_value_as_int(left); \
+    double r = yuji_value_as_float(right); \
+    return yuji_value_float_init(EXPR); \
+  } \
+  static YujiValue* NAME##_float_int(YujiValue* left, YujiValue* right) { \
+    double l = yuji_value_as_float(left); \
+    double r = (double)yuji_value_as_int(right); \
+    return yuji_value_float_init(EXPR); \
+  } \
+  static YujiValue* NAME##_float_float(YujiValue* left, YujiValue* right) { \
+    double l = yuji_value_as_float(left); \
+    double r = yuji_value_as_float(right); \
+    return yuji_value_float_init(EXPR); \
+  }
+
+#define _YUJI_COMPARE_KERNELS(NAME, OP) \
+  static YujiValue* NAME##_int_int(YujiValue* left, YujiValue* right) { \
+    return yuji_value_bool_init(yuji_value_as_int(left) OP yuji_value_as_int(right)); \
+  } \
+  static YujiValue* NAME##_int_float(YujiValue* left, YujiValue* right) { \
+    return yuji_value_bool_init((double)yuji_value_as_int(left) OP yuji_value_as_float(right)); \
+  } \
+  static YujiValue* NAME##_float_int(YujiValue* left, YujiValue* right) { \
+    return yuji_value_bool_init(yuji_value_as_float(left) OP (double)yuji_value_as_int(right)); \
+  } \
+  static YujiValue* NAME##_float_float(YujiValue* left, YujiValue* right) { \
+    return yuji_value_bool_init(yuji_value_as_float(left) OP yuji_value_as_float(right)); \
+  } \
+  static YujiValue* NAME##_string_string(YujiValue* left, YujiValue* right) { \
+    return yuji_value_bool_init(compare_strings(left->value.string, right->value.string) OP 0); \
+  }
+
+#define _YUJI_KERNEL_ROW(NAME) \
+  [YUJI_OPERAND_PAIR(YUJI_OPERAND_INT, YUJI_OPERAND_INT)] = NAME##_int_int, \
+  [YUJI_OPERAND_PAIR(YUJI_OPERAND_INT, YUJI_OPERAND_FLOAT)] = NAME##_int_float, \
+  [YUJI_OPERAND_PAIR(YUJI_OPERAND_FLOAT, YUJI_OPERAND_INT)] = NAME##_float_int, \
+  [YUJI_OPERAND_PAIR(YUJI_OPERAND_FLOAT, YUJI_OPERAND_FLOAT)] = NAME##_float_float
+
+#define _YUJI_COMPARE_KERNEL_ROW(NAME) \
+  _YUJI_KERNEL_ROW(NAME), \
+  [YUJI_OPERAND_PAIR(YUJI_OPERAND_STRING, YUJI_OPERAND_STRING)] = NAME##_string_string
+
+static inline double check_divisor(double r) {
+  if (r == 0.0) {
+    yuji_panic("division by zero");
+  }
+
+  return r;
+}
+
+// integer division and modulo truncate toward zero like C does, the only
+// overflowing case is INT64_MIN / -1
+static inline void check_int_divisor(int64_t l, int64_t r) {
+  if (r == 0) {
+    yuji_panic("division by zero");
+  }
+
+  if (l == INT64_MIN && r == -1) {
+    yuji_panic("integer overflow in %" PRId64 " / %" PRId64, l, r);
+  }
+}
+
+static int compare_strings(YujiString* left, YujiString* right) {
+  size_t size = left->size < right->size ? left->size : right->size;
+  int cmp = memcmp(left->data, right->data, size);
+
+  if (cmp != 0) {
+    return cmp;
+  }
+
+  return (left->size > right->size) - (left->size < right->size);
+}
+
+_YUJI_ARITH_KERNELS(add, __builtin_add_overflow, +)
+_YUJI_ARITH_KERNELS(sub, __builtin_sub_overflow, -)
+_YUJI_ARITH_KERNELS(mul, __builtin_mul_overflow, *)
+
+// a left operand nobody else references is extended in place; its buffer
+// grows geometrically, so building a string piece by piece stays linear
+static YujiValue* add_string_string(YujiValue* left, YujiValue* right) {
+  YujiString* l = left->value.string;
+  YujiString* r = right->value.string;
+
+  if (left->refcount == 1) {
+    yuji_string_append(l, r->data, r->size);
+    yuji_value_ref(left);
+    return left;
+  }
+
+  YujiString* result = yuji_string_init();
+  yuji_string_reserve(result, l->size + r->size);
+  yuji_string_append(result, l->data, l->size);
+  yuji_string_append(result, r->data, r->size);
+  return yuji_value_string_adopt_init(result);
+}
+
+static YujiValue* div_int_int(YujiValue* left, YujiValue* right) {
+  check_int_divisor(yuji_value_as_int(left), yuji_value_as_int(right));
+  return yuji_value_int_init(yuji_value_as_int(left) / yuji_value_as_int(right));
+}
+
+_YUJI_FLOAT_KERNELS(div, l / check_divisor(r))
+
+// modulo always produces an int, float operands are truncated first
+static YujiValue* mod_int_int(YujiValue* left, YujiValue* right) {
+  check_int_divisor(yuji_value_as_int(left), yuji_value_as_int(right));
+  return yuji_value_int_init(yuji_value_as_int(left) % yuji_value_as_int(right));
+}
+
+#define _YUJI_MOD_KERNEL(NAME, LEFT, RIGHT) \
+  static YujiValue* NAME(YujiValue* left, YujiValue* right) { \
+    int64_t l = (int64_t)(LEFT); \
+    int64_t r = (int64_t)(RIGHT); \
+    check_int_divisor(l, r); \
+    return yuji_value_int_init(l % r); \
+  }
+
+_YUJI_MOD_KERNEL(mod_int_float, yuji_value_as_int(left), yuji_value_as_float(right))
+_YUJI_MOD_KERNEL(mod_float_int, yuji_value_as_float(left), yuji_value_as_int(right))
+_YUJI_MOD_KERNEL(mod_float_float, yuji_value_as_float(left), yuji_value_as_float(right))
+
+_YUJI_COMPARE_KERNELS(lt, <)
+_YUJI_COMPARE_KERNELS(gt, >)
+_YUJI_COMPARE_KERNELS(lte, <=)
+_YUJI_COMPARE_KERNELS(gte, >=)
+_YUJI_COMPARE_KERNELS(eq, ==)
+_YUJI_COMPARE_KERNELS(neq, !=)
+
+static const YujiOperatorKernel kernels[YUJI_OPERATOR_COUNT][YUJI_OPERAND_PAIRS] = {
+  [YUJI_OPERATOR_ADD] = {
+    _YUJI_KERNEL_ROW(add),
+    [YUJI_OPERAND_PAIR(YUJI_OPERAND_STRING, YUJI_OPERAND_STRING)] = add_string_string,
+  },
+  [YUJI_OPERATOR_SUB] = { _YUJI_KERNEL_ROW(sub) },
+  [YUJI_OPERATOR_MUL] = { _YUJI_KERNEL_ROW(mul) },
+  [YUJI_OPERATOR_DIV] = { _YUJI_KERNEL_ROW(div) },
+  [YUJI_OPERATOR_MOD] = { _YUJI_KERNEL_ROW(mod) },
+  [YUJI_OPERATOR_LT] = { _YUJI_COMPARE_KERNEL_ROW(lt) },
+  [YUJI_OPERATOR_GT] = { _YUJI_COMPARE_KERNEL_ROW(gt) },
+  [YUJI_OPERATOR_LTE] = { _YUJI_COMPARE_KERNEL_ROW(lte) },
+  [YUJI_OPERATOR_GTE] = { _YUJI_COMPARE_KERNEL_ROW(gte) },
+  [YUJI_OPERATOR_EQ] = { _YUJI_COMPARE_KERNEL_ROW(eq) },
+  [YUJI_OPERATOR_NEQ] = { _YUJI_COMPARE_KERNEL_ROW(neq) },
+};
+
+#undef _YUJI_ARITH_KERNELS
+#undef _YUJI_FLOAT_KERNELS
+#undef _YUJI_MOD_KERNEL
+#undef _YUJI_COMPARE_KERNELS
+#undef _YUJI_KERNEL_ROW
+#undef _YUJI_COMPARE_KERNEL_ROW
+
+// equality for operands without a dedicated kernel: values of different
+// types are never equal, reference types compare by identity
+static bool values_equal(YujiValue* left, YujiValue* right) {
+  if (yuji_value_type(left) != yuji_value_type(right)) {
+    return false;
+  }
+
+  switch (yuji_value_type(left)) {
+    case VT_NULL:
+    case VT_BOOL:
+      return left == right;
+
+    case VT_FUNCTION:
+      return left == right ||
+             (left->value.function.node == right->value.function.node &&
+              left->value.function.proto == right->value.function.proto);
+
+    case VT_CFUNCTION:
+      return left->value.cfunction == right->value.cfunction;
+
+    case VT_ARRAY:
+      return left->value.array == right->value.array;
+
+    default:
+      return false;
+  }
+}
+
+// bools take part in arithmetic and comparisons as 0 and 1, which chained
+// comparisons such as `a < b && c < d` rely on
+static YujiValue* promote_bool(YujiValue* value) {
+  if (yuji_value_type(value) != VT_BOOL) {
+    return value;
+  }
+
+  return yuji_value_int_init(yuji_value_as_bool(value));
+}
+
+static inline YujiOperatorKernel lookup_kernel(YujiOperator op, YujiValue* left,
+                                               YujiValue* right) {
+  return kernels[op][YUJI_OPERAND_PAIR(operand_kinds[yuji_value_type(left)],
+                                       operand_kinds[yuji_value_type(right)])];
+}
+
+YujiValue* yuji_operator_eval(YujiOperator op, YujiValue* left, YujiValue* right) {
+  YujiOperatorKernel kernel = lookup_kernel(op, left, right);
+
+  if (kernel) {
+    return kernel(left, right);
+  }
+
+  if (op != YUJI_OPERATOR_AND && op != YUJI_OPERATOR_OR &&
+      (yuji_value_type(left) == VT_BOOL || yuji_value_type(right) == VT_BOOL)) {
+    YujiValue* l = promote_bool(left);
+    YujiValue* r = promote_bool(right);
+
+    kernel = lookup_kernel(op, l, r);
+
+    if (kernel) {
+      return kernel(l, r);
+    }
+  }
+
+  switch (op) {
+    case YUJI_OPERATOR_EQ:
+      return yuji_value_bool_init(values_equal(left, right));
+
+    case YUJI_OPERATOR_NEQ:
+      return yuji_value_bool_init(!values_equal(left, right));
+
+    case YUJI_OPERATOR_AND:
+      return yuji_value_bool_init(yuji_value_to_bool(left) && yuji_value_to_bool(right));
+
+    case YUJI_OPERATOR_OR:
+      return yuji_value_bool_init(yuji_value_to_bool(left) || yuji_value_to_bool(right));
+
+    default:
+      break;
+  }
+
+  yuji_panic("unsupported operand types for %s: %s and %s", yuji_operator_to_string(op),
+             yuji_value_type_to_string(yuji_value_type(left)),
+             yuji_value_type_to_string(yuji_value_type(right)));
+}
+
+YujiValue* yuji_operator_eval_update(YujiOperator op, YujiValue* left, YujiValue* right) {
+  if (!yuji_value_is_heap(left)) {
+    return yuji_operator_eval(op, left, right);
+  }
+
+  left->refcount--;
+  YujiValue* result = yuji_operator_eval(op, left, right);
+  left->refcount++;
+
+  return result;
+}
@@ -0,0 +1,462 @@
+#include "yuji/core/optimizer.h"
+#include "yuji/core/memory.h"
+#include "yuji/core/operator.h"
+#include "yuji/core/types/arena.h"
+#include "yuji/core/types/dyn_array.h"
+#include "yuji/core/value.h"
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+  YujiArena* arena;
+  size_t folded;
+  size_t pruned;
+} YujiOptimizer;
+
+static size_t total_modules = 0;
+static size_t total_folded = 0;
+static size_t total_pruned = 0;
+static size_t total_removed = 0;
+
+static size_t count_nodes(YujiASTNode* node);
+
+static size_t count_exprs(YujiDynArray* exprs) {
+  size_t count = 0;
+
+  YUJI_DYN_ARRAY_ITER(exprs, YujiASTNode, expr, {
+    count += count_nodes(expr);
+  })
+
+  return count;
+}
+
+static size_t count_nodes(YujiASTNode* node) {
+  switch (node->type) {
+    case YUJI_AST_MODULE:
+      return 1 + count_exprs(node->value.module->exprs);
+
+    case YUJI_AST_BIN_OP:
+      return 1 + count_nodes(node->value.bin_op->left) + count_nodes(node->value.bin_op->right);
+
+    case YUJI_AST_ASSIGN:
+      return 1 + count_nodes(node->value.assign->value);
+
+    case YUJI_AST_LET:
+      return 1 + count_nodes(node->value.let->value);
+
+    case YUJI_AST_BLOCK:
+      return 1 + count_exprs(node->value.block->exprs);
+
+    case YUJI_AST_FN:
+      return 1 + count_nodes(node->value.fn->body);
+
+    case YUJI_AST_CALL:
+      return 1 + count_exprs(node->value.call->args);
+
+    case YUJI_AST_WHILE:
+      return 1 + count_nodes(node->value.while_stmt->condition) +
+             count_exprs(node->value.while_stmt->body->exprs);
+
+    case YUJI_AST_IF: {
+      size_t count = 1;
+
+      YUJI_DYN_ARRAY_ITER(node->value.if_stmt->branches, YujiASTIfBranch, branch, {
+        count += count_nodes(branch->condition) + count_exprs(branch->body->exprs);
+      })
+
+      if (node->value.if_stmt->else_body) {
+        count += count_exprs(node->value.if_stmt->else_body->exprs);
+      }
+
+      return count;
+    }
+
+    case YUJI_AST_RETURN:
+      return 1 + count_nodes(node->value.return_stmt->value);
+
+    case YUJI_AST_ARRAY:
+      return 1 + count_exprs(node->value.array->elements);
+
+    case YUJI_AST_INDEX_ACCESS:
+      return 1 + count_nodes(node->value.index_access->object) +
+             count_nodes(node->value.index_access->index);
+
+    case YUJI_AST_INDEX_ASSIGN:
+      return 1 + count_nodes(node->value.index_assign->object) +
+             count_nodes(node->value.index_assign->index) +
+             count_nodes(node->value.index_assign->value);
+
+    default:
+      return 1;
+  }
+}
+
+static bool is_literal(YujiASTNode* node) {
+  switch (node->type) {
+    case YUJI_AST_INT:
+    case YUJI_AST_FLOAT:
+    case YUJI_AST_STRING:
+    case YUJI_AST_BOOL:
+    case YUJI_AST_NULL:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+static YujiValue* literal_value(YujiASTNode* node) {
+  switch (node->type) {
+    case YUJI_AST_INT:
+      return yuji_value_int_init(node->value.int_->value);
+
+    case YUJI_AST_FLOAT:
+      return yuji_value_float_init(node->value.float_->value);
+
+    case YUJI_AST_STRING:
+      return yuji_value_string_init(node->value.string->value);
+
+    case YUJI_AST_BOOL:
+      return yuji_value_bool_init(node->value.boolean->value);
+
+    default:
+      return yuji_value_null_init();
+  }
+}
+
+// NULL if the value has no literal syntax
+static YujiASTNode* literal_node(YujiArena* arena, YujiValue* value) {
+  switch (yuji_value_type(value)) {
+    case VT_INT:
+      return yuji_ast_int_init(arena, yuji_value_as_int(value));
+
+    case VT_FLOAT:
+      return yuji_ast_float_init(arena, yuji_value_as_float(value));
+
+    case VT_BOOL:
+      return yuji_ast_bool_init(arena, yuji_value_as_bool(value));
+
+    case VT_STRING: {
+      YujiString* string = value->value.string;
+
+      // string nodes are NUL-terminated
+      if (memchr(string->data, '\0', string->size)) {
+        return NULL;
+      }
+
+      char* data = yuji_arena_alloc(arena, string->size + 1);
+      memcpy(data, string->data, string->size);
+      data[string->size] = '\0';
+
+      return yuji_ast_string_init(arena, data);
+    }
+
+    default:
+      return NULL;
+  }
+}
+
+// bools take part in arithmetic as 0 and 1
+static bool is_int_like(YujiValue* value) {
+  YujiValueType type = yuji_value_type(value);
+  return type == VT_INT || type == VT_BOOL;
+}
+
+static bool is_number_like(YujiValue* value) {
+  return is_int_like(value) || yuji_value_type(value) == VT_FLOAT;
+}
+
+static int64_t int_like_value(YujiValue* value) {
+  return yuji_value_type(value) == VT_BOOL ? yuji_value_as_bool(value) : yuji_value_as_int(value);
+}
+
+// true if yuji_operator_eval returns a value for these operands instead of
+// panicking, whatever cannot be decided here is left to run time
+static bool can_fold(YujiOperator op, YujiValue* left, YujiValue* right) {
+  if (op == YUJI_OPERATOR_AND || op == YUJI_OPERATOR_OR || op == YUJI_OPERATOR_EQ ||
+      op == YUJI_OPERATOR_NEQ) {
+    return true;
+  }
+
+  if (yuji_value_type(left) == VT_STRING && yuji_value_type(right) == VT_STRING) {
+    return op == YUJI_OPERATOR_ADD || op >= YUJI_OPERATOR_LT;
+  }
+
+  if (!is_number_like(left) || !is_number_like(right)) {
+    return false;
+  }
+
+  if (op >= YUJI_OPERATOR_LT) {
+    return true;
+  }
+
+  if (!is_int_like(left) || !is_int_like(right)) {
+    switch (op) {
+      case YUJI_OPERATOR_DIV:
+        return (yuji_value_type(right) == VT_FLOAT ? yuji_value_as_float(right)
+                                                   : (double)int_like_value(right)) != 0.0;
+
+      case YUJI_OPERATOR_MOD:
+        return false;
+
+      default:
+        return true;
+    }
+  }
+
+  int64_t l = int_like_value(left);
+  int64_t r = int_like_value(right);
+  int64_t result;
+
+  switch (op) {
+    case YUJI_OPERATOR_ADD:
+      return !__builtin_add_overflow(l, r, &result);
+
+    case YUJI_OPERATOR_SUB:
+      return !__builtin_sub_overflow(l, r, &result);
+
+    case YUJI_OPERATOR_MUL:
+      return !__builtin_mul_overflow(l, r, &result);
+
+    default:
+      return r != 0 && !(l == INT64_MIN && r == -1);
+  }
+}
+
+// -1 if `node` is not a literal, else whether it is truthy
+static int literal_truth(YujiASTNode* node) {
+  if (!is_literal(node)) {
+    return -1;
+  }
+
+  YujiValue* value = literal_value(node);
+  bool truthy = yuji_value_to_bool(value);
+  yuji_value_free(value);
+
+  return truthy;
+}
+
+static YujiASTNode* optimize(YujiOptimizer* optimizer, YujiASTNode* node);
+
+// drops literals whose value is thrown away, which is every expression but
+// the last one, the value of the block
+static void optimize_exprs(YujiOptimizer* optimizer, YujiDynArray* exprs) {
+  size_t kept = 0;
+
+  for (size_t i = 0; i < exprs->size; i++) {
+    YujiASTNode* expr = optimize(optimizer, exprs->data[i]);
+
+    if (i + 1 < exprs->size && is_literal(expr)) {
+      continue;
+    }
+
+    exprs->data[kept++] = expr;
+  }
+
+  exprs->size = kept;
+}
+
+static YujiASTNode* optimize_bin_op(YujiOptimizer* optimizer, YujiASTNode* node) {
+  YujiASTBinOp* bin_op = node->value.bin_op;
+  bin_op->left = optimize(optimizer, bin_op->left);
+  bin_op->right = optimize(optimizer, bin_op->right);
+
+  // `false && x` and `true || x` never evaluate x
+  if ((bin_op->operator == YUJI_OPERATOR_AND || bin_op->operator == YUJI_OPERATOR_OR) &&
+      literal_truth(bin_op->left) == (bin_op->operator == YUJI_OPERATOR_OR)) {
+    optimizer->folded++;
+    return yuji_ast_bool_init(optimizer->arena, bin_op->operator == YUJI_OPERATOR_OR);
+  }
+
+  if (!is_literal(bin_op->left) || !is_literal(bin_op->right)) {
+    return node;
+  }
+
+  YujiValue* left = literal_value(bin_op->left);
+  YujiValue* right = literal_value(bin_op->right);
+  YujiASTNode* folded = NULL;
+
+  if (can_fold(bin_op->operator, left, right)) {
+    YujiValue* result;
+
+    // `&&` and `||` are compiled to jumps and have no kernel
+    if (bin_op->operator == YUJI_OPERATOR_AND) {
+      result = yuji_value_bool_init(yuji_value_to_bool(left) && yuji_value_to_bool(right));
+    } else if (bin_op->operator == YUJI_OPERATOR_OR) {
+      result = yuji_value_bool_init(yuji_value_to_bool(left) || yuji_value_to_bool(right));
+    } else {
+      result = yuji_operator_eval(bin_op->operator, left, right);
+    }
+
+    folded = literal_node(optimizer->arena, result);
+    yuji_value_free(result);
+  }
+
+  yuji_value_free(left);
+  yuji_value_free(right);
+
+  if (!folded) {
+    return node;
+  }
+
+  optimizer->folded++;
+  return folded;
+}
+
+// the first branch with a truthy literal condition becomes the else body and
+// ends the chain, branches with a falsy one are dropped. a chain left without
+// branches is replaced by its else body
+static YujiASTNode* optimize_if(YujiOptimizer* optimizer, YujiASTNode* node) {
+  YujiASTIf* if_stmt = node->value.if_stmt;
+  YujiDynArray* branches = if_stmt->branches;
+  YujiASTBlock* else_body = if_stmt->else_body;
+  size_t kept = 0;
+
+  for (size_t i = 0; i < branches->size; i++) {
+    YujiASTIfBranch* branch = branches->data[i];
+    branch->condition = optimize(optimizer, branch->condition);
+
+    int truth = literal_truth(branch->condition);
+
+    if (truth == 0) {
+      optimizer->pruned++;
+      continue;
+    }
+
+    optimize_exprs(optimizer, branch->body->exprs);
+
+    // the branches after this one and the original else body never run
+    if (truth == 1) {
+      optimizer->pruned += branches->size - i;
+
+      if (else_body) {
+        optimizer->pruned++;
+      }
+
+      if_stmt->else_body = branch->body;
+      break;
+    }
+
+    branches->data[kept++] = branch;
+  }
+
+  branches->size = kept;
+
+  if (else_body && if_stmt->else_body == else_body) {
+    optimize_exprs(optimizer, else_body->exprs);
+  }
+
+  if (kept > 0) {
+    return node;
+  }
+
+  if (!if_stmt->else_body) {
+    return yuji_ast_null_init(optimizer->arena);
+  }
+
+  return yuji_ast_block_init(optimizer->arena, if_stmt->else_body->exprs);
+}
+
+static YujiASTNode* optimize(YujiOptimizer* optimizer, YujiASTNode* node) {
+  switch (node->type) {
+    case YUJI_AST_BIN_OP:
+      return optimize_bin_op(optimizer, node);
+
+    case YUJI_AST_IF:
+      return optimize_if(optimizer, node);
+
+    case YUJI_AST_WHILE: {
+      YujiASTWhile* while_stmt = node->value.while_stmt;
+      while_stmt->condition = optimize(optimizer, while_stmt->condition);
+
+      // a loop that never runs evaluates to null
+      if (literal_truth(while_stmt->condition) == 0) {
+        optimizer->pruned++;
+        return yuji_ast_null_init(optimizer->arena);
+      }
+
+      optimize_exprs(optimizer, while_stmt->body->exprs);
+      return node;
+    }
+
+    case YUJI_AST_ASSIGN:
+      node->value.assign->value = optimize(optimizer, node->value.assign->value);
+      return node;
+
+    case YUJI_AST_LET:
+      node->value.let->value = optimize(optimizer, node->value.let->value);
+      return node;
+
+    case YUJI_AST_BLOCK:
+      optimize_exprs(optimizer, node->value.block->exprs);
+      return node;
+
+    case YUJI_AST_FN:
+      optimize(optimizer, node->value.fn->body);
+      return node;
+
+    case YUJI_AST_CALL:
+      for (size_t i = 0; i < node->value.call->args->size; i++) {
+        node->value.call->args->data[i] = optimize(optimizer, node->value.call->args->data[i]);
+      }
+
+      return node;
+
+    case YUJI_AST_RETURN:
+      node->value.return_stmt->value = optimize(optimizer, node->value.return_stmt->value);
+      return node;
+
+    case YUJI_AST_ARRAY: {
+      YujiDynArray* elements = node->value.array->elements;
+
+      for (size_t i = 0; i < elements->size; i++) {
+        elements->data[i] = optimize(optimizer, elements->data[i]);
+      }
+
+      return node;
+    }
+
+    case YUJI_AST_INDEX_ACCESS:
+      node->value.index_access->object = optimize(optimizer, node->value.index_access->object);
+      node->value.index_access->index = optimize(optimizer, node->value.index_access->index);
+      return node;
+
+    case YUJI_AST_INDEX_ASSIGN:
+      node->value.index_assign->object = optimize(optimizer, node->value.index_assign->object);
+      node->value.index_assign->index = optimize(optimizer, node->value.index_assign->index);
+      node->value.index_assign->value = optimize(optimizer, node->value.index_assign->value);
+      return node;
+
+    default:
+      return node;
+  }
+}
+
+size_t yuji_optimizer_run(YujiASTModule* module) {
+  yuji_check_memory(module);
+
+  YujiOptimizer optimizer = {
+    .arena = module->arena,
+    .folded = 0,
+    .pruned = 0,
+  };
+
+  size_t before = count_exprs(module->exprs);
+  optimize_exprs(&optimizer, module->exprs);
+  size_t removed = before - count_exprs(module->exprs);
+
+  total_modules++;
+  total_folded += optimizer.folded;
+  total_pruned += optimizer.pruned;
+  total_removed += removed;
+
+  return removed;
+}
+
+void yuji_optimizer_print_stats(FILE* stream) {
+  fprintf(stream, "optimizer:\n");
+  fprintf(stream, "  %-22s %zu\n", "modules", total_modules);
+  fprintf(stream, "  %-22s %zu\n", "operators folded", total_folded);
+  fprintf(stream, "  %-22s %zu\n", "branches/loops pruned", total_pruned);
+  fprintf(stream, "  %-22s %zu\n", "nodes removed", total_removed);
+}
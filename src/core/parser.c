@@ -1,18 +1,56 @@
 #include "yuji/core/parser.h"
 #include "yuji/core/ast.h"
 #include "yuji/core/memory.h"
+#include "yuji/core/symbol.h"
 #include "yuji/core/token.h"
 #include "yuji/core/types/dyn_array.h"
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
-YujiParser* yuji_parser_init(YujiDynArray* tokens) {
+// string tokens are raw views with escapes, the lexer already validated them
+static char* decode_string(YujiArena* arena, const YujiToken* token) {
+  char* result = yuji_arena_alloc(arena, token->length + 1);
+  size_t size = 0;
+
+  for (size_t i = 0; i < token->length; i++) {
+    char c = token->start[i];
+
+    if (c == '\\') {
+      switch (token->start[++i]) {
+        case 'n':
+          c = '\n';
+          break;
+
+        case 't':
+          c = '\t';
+          break;
+
+        default:
+          c = token->start[i];
+          break;
+      }
+    }
+
+    result[size++] = c;
+  }
+
+  result[size] = '\0';
+  return result;
+}
+
+static char* token_name(YujiParser* parser) {
+  return (char*)yuji_symbol_intern_n(parser->current_token->start, parser->current_token->length);
+}
+
+YujiParser* yuji_parser_init(YujiTokenArray* tokens) {
   YujiParser* parser = yuji_malloc(sizeof(YujiParser));
 
   parser->tokens = tokens;
+  parser->arena = yuji_arena_init();
   parser->index = 0;
-  parser->current_token = yuji_dyn_array_get(parser->tokens, parser->index);
+  parser->current_token = tokens->size > 0 ? &tokens->data[0] : NULL;
 
   return parser;
 }
@@ -31,7 +69,7 @@ YujiToken* yuji_parser_advance(YujiParser* parser) {
     return NULL;
   }
 
-  YujiToken* token = yuji_dyn_array_get(parser->tokens, parser->index);
+  YujiToken* token = &parser->tokens->data[parser->index];
   parser->current_token = token;
   return token;
 }
@@ -51,13 +89,11 @@ bool yuji_parser_match(YujiParser* parser, YujiTokenType type) {
 bool yuji_parser_match_next(YujiParser *parser, YujiTokenType type) {
   yuji_check_memory(parser);
 
-  YujiToken *token = yuji_dyn_array_get(parser->tokens, parser->index + 1);
-
-  if (!token) {
+  if (parser->index + 1 >= parser->tokens->size) {
     return false;
   }
 
-  return token->type == type;
+  return parser->tokens->data[parser->index + 1].type == type;
 }
 
 void yuji_parser_expect(YujiParser* parser, YujiTokenType type) {
@@ -99,7 +135,9 @@ YujiASTNode* yuji_parser_parse(const char* module_name, YujiParser* parser) {
     yuji_dyn_array_push(exprs, stmt);
   }
 
-  return yuji_ast_module_init(module_name, exprs);
+  YujiASTNode* module = yuji_ast_module_init(parser->arena, module_name, exprs);
+  yuji_dyn_array_free(exprs);
+  return module;
 }
 
 YujiASTNode* yuji_parser_parse_block(YujiParser* parser) {
@@ -121,7 +159,7 @@ YujiASTNode* yuji_parser_parse_block(YujiParser* parser) {
     yuji_dyn_array_push(exprs, expr);
   }
 
-  YujiASTNode* block = yuji_ast_block_init(exprs);
+  YujiASTNode* block = yuji_ast_block_init(parser->arena, exprs);
   yuji_dyn_array_free(exprs);
   return block;
 }
@@ -133,20 +171,19 @@ YujiASTNode* yuji_parser_parse_stmt(YujiParser* parser) {
     yuji_parser_advance(parser);
 
     yuji_parser_expect(parser, TT_IDENTIFIER);
-    const char* name = parser->current_token->value;
+    char* name = token_name(parser);
 
     yuji_parser_advance(parser);
     yuji_parser_expect(parser, TT_ASSIGN);
     yuji_parser_advance(parser);
 
     YujiASTNode* value = yuji_parser_parse_expr(parser);
-
-    return yuji_ast_let_init(name, value);
+    return yuji_ast_let_init(parser->arena, name, value);
   } else if (yuji_parser_match(parser, TT_FN) && yuji_parser_match_next(parser, TT_IDENTIFIER)) {
     yuji_parser_advance(parser);
 
     yuji_parser_expect(parser, TT_IDENTIFIER);
-    const char* name = parser->current_token->value;
+    char* name = token_name(parser);
     yuji_parser_advance(parser);
 
     yuji_parser_expect(parser, TT_LPAREN);
@@ -157,7 +194,7 @@ YujiASTNode* yuji_parser_parse_stmt(YujiParser* parser) {
     if (!yuji_parser_match(parser, TT_RPAREN)) {
       do {
         yuji_parser_expect(parser, TT_IDENTIFIER);
-        char* param = strdup(parser->current_token->value);
+        char* param = token_name(parser);
         yuji_dyn_array_push(param_names, param);
         yuji_parser_advance(parser);
       } while (yuji_parser_match(parser, TT_COMMA) && yuji_parser_advance(parser));
@@ -166,12 +203,7 @@ YujiASTNode* yuji_parser_parse_stmt(YujiParser* parser) {
     yuji_parser_expect(parser, TT_RPAREN);
     yuji_parser_advance(parser);
     YujiASTNode* block_node = yuji_parser_parse_block(parser);
-    YujiASTNode* fn = yuji_ast_fn_init(name, param_names, block_node->value.block);
-    yuji_ast_free(block_node);
-
-    YUJI_DYN_ARRAY_ITER(param_names, char*, param, {
-      yuji_free(param);
-    });
+    YujiASTNode* fn = yuji_ast_fn_init(parser->arena, name, param_names, block_node);
     yuji_dyn_array_free(param_names);
 
     return fn;
@@ -182,7 +214,8 @@ YujiASTNode* yuji_parser_parse_stmt(YujiParser* parser) {
 
     YujiASTNode* condition = yuji_parser_parse_expr(parser);
     YujiASTNode* body = yuji_parser_parse_block(parser);
-    YujiASTIfBranch* if_branch = yuji_ast_if_branch_init(condition, yuji_ast_extract_block(body));
+    YujiASTIfBranch* if_branch = yuji_ast_if_branch_init(parser->arena, condition,
+                                 yuji_ast_extract_block(body));
     yuji_dyn_array_push(branches, if_branch);
 
     YujiASTBlock* else_body = NULL;
@@ -191,7 +224,7 @@ YujiASTNode* yuji_parser_parse_stmt(YujiParser* parser) {
       yuji_parser_advance(parser);
       YujiASTNode* elif_condition = yuji_parser_parse_expr(parser);
       YujiASTNode* elif_body = yuji_parser_parse_block(parser);
-      YujiASTIfBranch* elif_branch = yuji_ast_if_branch_init(elif_condition,
+      YujiASTIfBranch* elif_branch = yuji_ast_if_branch_init(parser->arena, elif_condition,
                                      yuji_ast_extract_block(elif_body));
       yuji_dyn_array_push(branches, elif_branch);
     }
@@ -202,7 +235,9 @@ YujiASTNode* yuji_parser_parse_stmt(YujiParser* parser) {
       else_body = yuji_ast_extract_block(else_node);
     }
 
-    return yuji_ast_if_init(branches, else_body);
+    YujiASTNode* if_node = yuji_ast_if_init(parser->arena, branches, else_body);
+    yuji_dyn_array_free(branches);
+    return if_node;
   } else if (yuji_parser_match(parser, TT_WHILE)) {
     yuji_parser_advance(parser);
 
@@ -210,16 +245,16 @@ YujiASTNode* yuji_parser_parse_stmt(YujiParser* parser) {
 
     yuji_parser_expect(parser, TT_LBRACE);
     YujiASTNode* body = yuji_parser_parse_block(parser);
-    YujiASTNode* while_node = yuji_ast_while_init(condition, yuji_ast_extract_block(body));
+    YujiASTNode* while_node = yuji_ast_while_init(parser->arena, condition, yuji_ast_extract_block(body));
     return while_node;
   } else if (yuji_parser_match(parser, TT_USE)) {
     yuji_parser_advance(parser);
 
     yuji_parser_expect(parser, TT_STRING);
-    const char* name = parser->current_token->value;
+    char* name = token_name(parser);
     yuji_parser_advance(parser);
 
-    return yuji_ast_use_init(name);
+    return yuji_ast_use_init(parser->arena, name);
   } else if (yuji_parser_match(parser, TT_IDENTIFIER)
              && yuji_parser_match_next(parser, TT_LBRACKET)) {
     YujiASTNode* array = yuji_parser_parse_expr(parser);
@@ -229,14 +264,12 @@ YujiASTNode* yuji_parser_parse_stmt(YujiParser* parser) {
       YujiASTNode* value = yuji_parser_parse_expr(parser);
 
       if (array->type == YUJI_AST_INDEX_ACCESS) {
-        YujiASTNode* result = yuji_ast_index_assign_init(
-                                array->value.index_access->object,
-                                array->value.index_access->index,
-                                value
-                              );
-        yuji_free(array->value.index_access);
-        yuji_free(array);
-        return result;
+        return yuji_ast_index_assign_init(
+                 parser->arena,
+                 array->value.index_access->object,
+                 array->value.index_access->index,
+                 value
+               );
       } else {
         yuji_panic("parser error: expected index access before assignment");
       }
@@ -244,25 +277,25 @@ YujiASTNode* yuji_parser_parse_stmt(YujiParser* parser) {
 
     return array;
   } else if (yuji_parser_match(parser, TT_IDENTIFIER) && yuji_parser_match_next(parser, TT_ASSIGN)) {
-    const char* name = parser->current_token->value;
+    char* name = token_name(parser);
     yuji_parser_advance(parser);
     yuji_parser_advance(parser);
 
     YujiASTNode* value = yuji_parser_parse_expr(parser);
-    return yuji_ast_assign_init(name, value);
+    return yuji_ast_assign_init(parser->arena, name, value);
   } else if (yuji_parser_match(parser, TT_RETURN)) {
     yuji_parser_advance(parser);
 
     YujiASTNode* value = yuji_parser_parse_expr(parser);
-    return yuji_ast_return_init(value);
+    return yuji_ast_return_init(parser->arena, value);
   } else if (yuji_parser_match(parser, TT_BREAK)) {
     yuji_parser_advance(parser);
 
-    return yuji_ast_break_init();
+    return yuji_ast_break_init(parser->arena);
   } else if (yuji_parser_match(parser, TT_CONTINUE)) {
     yuji_parser_advance(parser);
 
-    return yuji_ast_continue_init();
+    return yuji_ast_continue_init(parser->arena);
   } else if (yuji_parser_match(parser, TT_IDENTIFIER) &&
              (yuji_parser_match_next(parser, TT_ASSIGN) ||
               yuji_parser_match_next(parser, TT_PLUS_ASSIGN) ||
@@ -270,47 +303,19 @@ YujiASTNode* yuji_parser_parse_stmt(YujiParser* parser) {
               yuji_parser_match_next(parser, TT_MUL_ASSIGN) ||
               yuji_parser_match_next(parser, TT_DIV_ASSIGN) ||
               yuji_parser_match_next(parser, TT_MOD_ASSIGN))) {
-    const char* name = parser->current_token->value;
+    char* name = token_name(parser);
     yuji_parser_advance(parser);
     YujiTokenType assign_type = parser->current_token->type;
     yuji_parser_advance(parser);
 
     YujiASTNode* value = yuji_parser_parse_expr(parser);
 
-    if (assign_type == TT_ASSIGN) {
-      return yuji_ast_assign_init(name, value);
+    if (assign_type != TT_ASSIGN) {
+      YujiASTNode* left = yuji_ast_identifier_init(parser->arena, name);
+      value = yuji_ast_bin_op_init(parser->arena, left, yuji_operator_from_token(assign_type), value);
     }
 
-    const char* op = NULL;
-
-    switch (assign_type) {
-      case TT_PLUS_ASSIGN:
-        op = "+";
-        break;
-
-      case TT_MINUS_ASSIGN:
-        op = "-";
-        break;
-
-      case TT_MUL_ASSIGN:
-        op = "*";
-        break;
-
-      case TT_DIV_ASSIGN:
-        op = "/";
-        break;
-
-      case TT_MOD_ASSIGN:
-        op = "%";
-        break;
-
-      default:
-        break;
-    }
-
-    YujiASTNode* left = yuji_ast_identifier_init(name);
-    YujiASTNode* binop = yuji_ast_bin_op_init(left, op, value);
-    return yuji_ast_assign_init(name, binop);
+    return yuji_ast_assign_init(parser->arena, name, value);
   }
 
   return yuji_parser_parse_expr(parser);
@@ -331,10 +336,10 @@ YujiASTNode* yuji_parser_parse_expr(YujiParser* parser) {
           yuji_parser_match(parser, TT_LTE) ||
           yuji_parser_match(parser, TT_AND) ||
           yuji_parser_match(parser, TT_OR))) {
-    char* op = (char*)parser->current_token->value;
+    YujiOperator op = yuji_operator_from_token(parser->current_token->type);
     yuji_parser_advance(parser);
     YujiASTNode* right = yuji_parser_parse_term(parser);
-    node = yuji_ast_bin_op_init(node, op, right);
+    node = yuji_ast_bin_op_init(parser->arena, node, op, right);
   }
 
   return node;
@@ -348,10 +353,10 @@ YujiASTNode* yuji_parser_parse_term(YujiParser* parser) {
          (yuji_parser_match(parser, TT_MUL) ||
           yuji_parser_match(parser, TT_DIV) ||
           yuji_parser_match(parser, TT_MOD))) {
-    char* op = (char*)parser->current_token->value;
+    YujiOperator op = yuji_operator_from_token(parser->current_token->type);
     yuji_parser_advance(parser);
     YujiASTNode* right = yuji_parser_parse_factor(parser);
-    node = yuji_ast_bin_op_init(node, op, right);
+    node = yuji_ast_bin_op_init(parser->arena, node, op, right);
   }
 
   return node;
@@ -365,19 +370,30 @@ YujiASTNode* yuji_parser_parse_factor(YujiParser* parser) {
 
   switch (token->type) {
     case TT_NUMBER: {
-      if (strchr(token->value, '.') != NULL) {
-        double v = strtod(token->value, NULL);
-        yuji_parser_advance(parser);
-        return yuji_ast_float_init(v);
+      char* text = yuji_token_strdup(token);
+      YujiASTNode* node;
+
+      if (memchr(token->start, '.', token->length) != NULL) {
+        node = yuji_ast_float_init(parser->arena, strtod(text, NULL));
       } else {
-        int64_t v = strtoll(token->value, NULL, 10);
-        yuji_parser_advance(parser);
-        return yuji_ast_int_init(v);
+        errno = 0;
+        int64_t v = strtoll(text, NULL, 10);
+
+        if (errno == ERANGE) {
+          yuji_panic("parser error: integer literal %s is out of range at %s", text,
+                     yuji_position_to_string(token->position));
+        }
+
+        node = yuji_ast_int_init(parser->arena, v);
       }
+
+      yuji_free(text);
+      yuji_parser_advance(parser);
+      return node;
     }
 
     case TT_STRING: {
-      YujiASTNode* node = yuji_ast_string_init(token->value);
+      YujiASTNode* node = yuji_ast_string_init(parser->arena, decode_string(parser->arena, token));
       yuji_parser_advance(parser);
       return node;
     }
@@ -395,7 +411,7 @@ YujiASTNode* yuji_parser_parse_factor(YujiParser* parser) {
       if (!yuji_parser_match(parser, TT_RPAREN)) {
         do {
           yuji_parser_expect(parser, TT_IDENTIFIER);
-          char* param = strdup(parser->current_token->value);
+          char* param = token_name(parser);
           yuji_dyn_array_push(param_names, param);
           yuji_parser_advance(parser);
         } while (yuji_parser_match(parser, TT_COMMA) && yuji_parser_advance(parser));
@@ -405,12 +421,7 @@ YujiASTNode* yuji_parser_parse_factor(YujiParser* parser) {
       yuji_parser_advance(parser);
 
       YujiASTNode* block_node = yuji_parser_parse_block(parser);
-      YujiASTNode* fn_node = yuji_ast_fn_init(name, param_names, block_node->value.block);
-      yuji_ast_free(block_node);
-
-      YUJI_DYN_ARRAY_ITER(param_names, char*, param, {
-        yuji_free(param);
-      });
+      YujiASTNode* fn_node = yuji_ast_fn_init(parser->arena, name, param_names, block_node);
       yuji_dyn_array_free(param_names);
 
       return fn_node;
@@ -418,7 +429,7 @@ YujiASTNode* yuji_parser_parse_factor(YujiParser* parser) {
 
 
     case TT_IDENTIFIER: {
-      const char* name = token->value;
+      char* name = token_name(parser);
       yuji_parser_advance(parser);
 
       if (yuji_parser_match(parser, TT_LPAREN)) {
@@ -440,41 +451,42 @@ YujiASTNode* yuji_parser_parse_factor(YujiParser* parser) {
         yuji_parser_expect(parser, TT_RPAREN);
         yuji_parser_advance(parser);
 
-        YujiASTNode* node = yuji_ast_call_init(name, args);
+        YujiASTNode* node = yuji_ast_call_init(parser->arena, name, args);
+        yuji_dyn_array_free(args);
 
         while (yuji_parser_match(parser, TT_LBRACKET)) {
           yuji_parser_advance(parser);
           YujiASTNode* index = yuji_parser_parse_expr(parser);
           yuji_parser_expect(parser, TT_RBRACKET);
           yuji_parser_advance(parser);
-          node = yuji_ast_index_access_init(node, index);
+          node = yuji_ast_index_access_init(parser->arena, node, index);
         }
 
         return node;
       }
 
-      YujiASTNode* node = yuji_ast_identifier_init(name);
+      YujiASTNode* node = yuji_ast_identifier_init(parser->arena, name);
 
       while (yuji_parser_match(parser, TT_LBRACKET)) {
         yuji_parser_advance(parser);
         YujiASTNode* index = yuji_parser_parse_expr(parser);
         yuji_parser_expect(parser, TT_RBRACKET);
         yuji_parser_advance(parser);
-        node = yuji_ast_index_access_init(node, index);
+        node = yuji_ast_index_access_init(parser->arena, node, index);
       }
 
       return node;
     }
 
     case TT_BOOL: {
-      bool value = strcmp(token->value, "true") == 0;
+      bool value = yuji_token_is(token, "true");
       yuji_parser_advance(parser);
-      return yuji_ast_bool_init(value);
+      return yuji_ast_bool_init(parser->arena, value);
     }
 
     case TT_NULL: {
       yuji_parser_advance(parser);
-      return yuji_ast_null_init();
+      return yuji_ast_null_init(parser->arena);
     }
 
     case TT_LPAREN: {
@@ -503,7 +515,9 @@ YujiASTNode* yuji_parser_parse_factor(YujiParser* parser) {
       yuji_parser_expect(parser, TT_RBRACKET);
       yuji_parser_advance(parser);
 
-      return yuji_ast_array_init(elements);
+      YujiASTNode* array = yuji_ast_array_init(parser->arena, elements);
+      yuji_dyn_array_free(elements);
+      return array;
     }
 
     default:
@@ -0,0 +1,105 @@
+#include "yuji/core/pool.h"
+#include "yuji/core/memory.h"
+#include <string.h>
+
+// under AddressSanitizer every block goes through malloc, so use-after-free
+// and leaks of pooled objects are still reported
+#if defined(__SANITIZE_ADDRESS__)
+#define _YUJI_POOL_PASSTHROUGH 1
+#else
+#define _YUJI_POOL_PASSTHROUGH 0
+#endif
+
+static YujiPoolClass pool_classes[YUJI_POOL_CLASSES];
+
+static size_t pool_class_index(size_t size) {
+  return (size + 7) / 8 - 1;
+}
+
+static void pool_refill(YujiPoolClass* class, size_t block_size) {
+  YujiPoolSlab* slab = yuji_malloc(sizeof(YujiPoolSlab) + YUJI_POOL_SLAB_SIZE);
+
+  slab->next = class->slabs;
+  class->slabs = slab;
+  class->cursor = (char*)(slab + 1);
+  class->end = class->cursor + YUJI_POOL_SLAB_SIZE / block_size * block_size;
+}
+
+void* yuji_pool_alloc(size_t size) {
+  if (size == 0 || size > YUJI_POOL_MAX_SIZE) {
+    return yuji_malloc(size);
+  }
+
+  YujiPoolClass* class = &pool_classes[pool_class_index(size)];
+  size_t block_size = (pool_class_index(size) + 1) * 8;
+
+  class->allocs++;
+
+  if (++class->live > class->peak) {
+    class->peak = class->live;
+  }
+
+  if (_YUJI_POOL_PASSTHROUGH) {
+    return yuji_malloc(size);
+  }
+
+  void* ptr;
+
+  if (class->free_list) {
+    ptr = class->free_list;
+    class->free_list = class->free_list->next;
+  } else {
+    if (class->cursor == class->end) {
+      pool_refill(class, block_size);
+    }
+
+    ptr = class->cursor;
+    class->cursor += block_size;
+  }
+
+  memset(ptr, 0, block_size);
+  return ptr;
+}
+
+void yuji_pool_free(void* ptr, size_t size) {
+  yuji_check_memory(ptr);
+
+  if (size == 0 || size > YUJI_POOL_MAX_SIZE) {
+    yuji_free(ptr);
+    return;
+  }
+
+  YujiPoolClass* class = &pool_classes[pool_class_index(size)];
+  class->live--;
+
+  if (_YUJI_POOL_PASSTHROUGH) {
+    yuji_free(ptr);
+    return;
+  }
+
+  YujiPoolBlock* block = ptr;
+  block->next = class->free_list;
+  class->free_list = block;
+}
+
+void yuji_pool_print_stats(FILE* stream) {
+  fprintf(stream, "memory pool:\n");
+  fprintf(stream, "  %6s %12s %12s %12s %8s\n", "size", "live", "peak", "allocs", "slabs");
+
+  for (size_t i = 0; i < YUJI_POOL_CLASSES; i++) {
+    YujiPoolClass* class = &pool_classes[i];
+
+    if (class->allocs == 0) {
+      continue;
+    }
+
+    size_t slabs = 0;
+
+    for (YujiPoolSlab* slab = class->slabs; slab; slab = slab->next) {
+      slabs++;
+    }
+
+    fprintf(stream, "  %6zu %12zu %12zu %12zu %8zu\n", (i + 1) * 8, class->live, class->peak,
+            class->allocs, slabs);
+  }
+}
@@ -3,13 +3,17 @@
 #include "yuji/core/interpreter.h"
 #include "yuji/core/lexer.h"
 #include "yuji/core/memory.h"
+#include "yuji/core/optimizer.h"
 #include "yuji/core/parser.h"
 #include "yuji/core/types/dyn_array.h"
-#include "yuji/core/types/string.h"
 #include "yuji/core/value.h"
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 YujiState* yuji_state_init() {
   YujiState* state = yuji_malloc(sizeof(YujiState));
@@ -26,67 +30,102 @@ void yuji_state_free(YujiState *state) {
   yuji_free(state);
 }
 
-static YujiDynArray* get_input(const char* str) {
-  YujiDynArray* result = yuji_dyn_array_init();
-  char* buffer = strdup(str);
-
-  char* token = strtok(buffer, "\n");
-
-  while (token) {
-    yuji_dyn_array_push(result, strdup(token));
-    token = strtok(NULL, "\n");
-  }
+void yuji_state_set_backend(YujiState* state, YujiBackend backend) {
+  yuji_check_memory(state);
 
-  yuji_free(buffer);
-  return result;
+  state->interpreter->backend = backend;
 }
 
-YujiASTNode* yuji_get_ast(const char* string, const char* source_name) {
+static YujiASTNode* parse_source(const char* source, size_t length, const char* source_name) {
   // LEXER
-  YujiDynArray* input = get_input(string);
-  YujiLexer* lexer = yuji_lexer_init(input, source_name);
-  YujiDynArray* tokens = yuji_dyn_array_init();
+  YujiLexer* lexer = yuji_lexer_init(source, length, source_name);
+  YujiTokenArray* tokens = yuji_token_array_init();
   yuji_lexer_tokenize(lexer, tokens);
 
   // PARSER
   YujiParser* parser = yuji_parser_init(tokens);
   YujiASTNode* ast = yuji_parser_parse(source_name, parser);
 
+  // OPTIMIZER
+  yuji_optimizer_run(ast->value.module);
+
   // CLEANUP
   yuji_parser_free(parser);
-
-  YUJI_DYN_ARRAY_ITER(tokens, YujiToken, token, {
-    yuji_token_free(token);
-  })
-  yuji_dyn_array_free(tokens);
-
-  YUJI_DYN_ARRAY_ITER(input, char*, line, {
-    yuji_free(line);
-  })
-  yuji_dyn_array_free(input);
+  yuji_token_array_free(tokens);
   yuji_lexer_free(lexer);
 
   return ast;
 }
 
+YujiASTNode* yuji_get_ast(const char* string, const char* source_name) {
+  return parse_source(string, strlen(string), source_name);
+}
+
+// fallback for files that cannot be mapped, such as pipes. reads the whole
+// file into one buffer, sized from fstat when it knows the size
+static char* read_source(int fd, size_t size_hint, size_t* length) {
+  size_t capacity = size_hint ? size_hint + 1 : 4096;
+  char* buffer = yuji_malloc(capacity);
+  size_t size = 0;
+
+  for (;;) {
+    if (size == capacity) {
+      capacity *= 2;
+      buffer = yuji_realloc(buffer, capacity);
+    }
+
+    ssize_t n = read(fd, buffer + size, capacity - size);
+
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+
+    if (n <= 0) {
+      if (n < 0) {
+        yuji_panic("error reading source: %s", strerror(errno));
+      }
+
+      break;
+    }
+
+    size += (size_t)n;
+  }
+
+  *length = size;
+  return buffer;
+}
+
 YujiASTNode* yuji_get_ast_from_file(const char* filename) {
-  FILE* file = fopen(filename, "r");
+  int fd = open(filename, O_RDONLY);
 
-  if (!file) {
+  if (fd < 0) {
     yuji_panic("error opening file '%s': %s", filename, strerror(errno));
   }
 
-  char buffer[64];
-  YujiString* str = yuji_string_init();
+  struct stat st;
 
-  while (fgets(buffer, sizeof(buffer), file)) {
-    yuji_string_append(str, buffer, strlen(buffer));
+  if (fstat(fd, &st) != 0) {
+    yuji_panic("error opening file '%s': %s", filename, strerror(errno));
   }
 
-  fclose(file);
-  YujiASTNode* ast = yuji_get_ast(str->data, filename);
-  yuji_string_free(str);
+  size_t size = S_ISREG(st.st_mode) ? (size_t)st.st_size : 0;
+  YujiASTNode* ast;
+
+  // the lexer reads the mapping directly, nothing is copied until the parser
+  // builds nodes
+  void* mapped = size > 0 ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+
+  if (mapped != MAP_FAILED) {
+    ast = parse_source(mapped, size, filename);
+    munmap(mapped, size);
+  } else {
+    size_t length;
+    char* source = read_source(fd, size, &length);
+    ast = parse_source(source, length, filename);
+    yuji_free(source);
+  }
 
+  close(fd);
   return ast;
 }
 
@@ -94,18 +133,12 @@ void yuji_eval_string(YujiState* state, const char* string) {
   yuji_check_memory(state);
   yuji_check_memory((void*)string);
 
-  YujiDynArray* input = get_input(string);
   YujiASTNode* ast = yuji_get_ast(string, "<string>");
-  YujiValue* result = yuji_interpreter_eval(state->interpreter, ast);
+  YujiValue* result = yuji_interpreter_run_module(state->interpreter, ast->value.module);
 
   yuji_value_free(result);
 
   yuji_ast_free(ast);
-
-  YUJI_DYN_ARRAY_ITER(input, char*, line, {
-    yuji_free(line);
-  })
-  yuji_dyn_array_free(input);
 }
 
 void yuji_eval_file(YujiState* state, const char* filename) {
@@ -113,7 +146,7 @@ void yuji_eval_file(YujiState* state, const char* filename) {
   yuji_check_memory((void*)filename);
 
   YujiASTNode* ast = yuji_get_ast_from_file(filename);
-  YujiValue * result = yuji_interpreter_eval(state->interpreter, ast);
+  YujiValue* result = yuji_interpreter_run_module(state->interpreter, ast->value.module);
 
   yuji_value_free(result);
 
@@ -0,0 +1,91 @@
+#include "yuji/core/symbol.h"
+#include "yuji/core/memory.h"
+#include "yuji/core/types/arena.h"
+#include <string.h>
+
+typedef struct {
+  const char* str;
+  size_t length;
+  uint32_t hash;
+} YujiSymbolSlot;
+
+// open-addressing set of every symbol, the characters live in an arena that
+// is never released
+static YujiSymbolSlot* symbol_slots = NULL;
+static size_t symbol_count = 0;
+static size_t symbol_capacity = 0;
+static YujiArena* symbol_arena = NULL;
+
+// FNV-1a
+static uint32_t symbol_hash_chars(const char* str, size_t length) {
+  uint32_t hash = 2166136261u;
+
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (unsigned char)str[i];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+static void symbol_grow() {
+  YujiSymbolSlot* old_slots = symbol_slots;
+  size_t old_capacity = symbol_capacity;
+
+  symbol_capacity = old_capacity ? old_capacity * 2 : YUJI_SYMBOL_INITIAL_CAPACITY;
+  symbol_slots = yuji_malloc(sizeof(YujiSymbolSlot) * symbol_capacity);
+
+  for (size_t i = 0; i < old_capacity; i++) {
+    if (!old_slots[i].str) {
+      continue;
+    }
+
+    size_t index = old_slots[i].hash & (symbol_capacity - 1);
+
+    while (symbol_slots[index].str) {
+      index = (index + 1) & (symbol_capacity - 1);
+    }
+
+    symbol_slots[index] = old_slots[i];
+  }
+
+  if (old_slots) {
+    yuji_free(old_slots);
+  }
+}
+
+const char* yuji_symbol_intern_n(const char* str, size_t length) {
+  // keep the load factor at or below 1/2
+  if ((symbol_count + 1) * 2 > symbol_capacity) {
+    symbol_grow();
+  }
+
+  uint32_t hash = symbol_hash_chars(str, length);
+  size_t index = hash & (symbol_capacity - 1);
+
+  while (symbol_slots[index].str) {
+    YujiSymbolSlot* slot = &symbol_slots[index];
+
+    if (slot->hash == hash && slot->length == length && memcmp(slot->str, str, length) == 0) {
+      return slot->str;
+    }
+
+    index = (index + 1) & (symbol_capacity - 1);
+  }
+
+  if (!symbol_arena) {
+    symbol_arena = yuji_arena_init();
+  }
+
+  YujiSymbolSlot* slot = &symbol_slots[index];
+  slot->str = yuji_arena_strndup(symbol_arena, str, length);
+  slot->length = length;
+  slot->hash = hash;
+  symbol_count++;
+
+  return slot->str;
+}
+
+const char* yuji_symbol_intern(const char* str) {
+  return yuji_symbol_intern_n(str, strlen(str));
+}
@@ -56,19 +56,39 @@ const char* yuji_token_type_to_string(const YujiTokenType type) {
 #undef _YUJI_TOKEN_TYPE_CASE
 }
 
-YujiToken* yuji_token_init(const char* value, const YujiTokenType type, YujiPosition position) {
-  YujiToken* token = yuji_malloc(sizeof(YujiToken));
+YujiTokenArray* yuji_token_array_init() {
+  YujiTokenArray* tokens = yuji_malloc(sizeof(YujiTokenArray));
 
-  token->value = value;
-  token->type = type;
-  token->position = position;
+  tokens->data = NULL;
+  tokens->size = 0;
+  tokens->capacity = 0;
 
-  return token;
+  return tokens;
 }
 
-void yuji_token_free(YujiToken* token) {
-  yuji_free((void*)token->value);
-  yuji_free(token);
+void yuji_token_array_free(YujiTokenArray* tokens) {
+  if (tokens->data) {
+    yuji_free(tokens->data);
+  }
+
+  yuji_free(tokens);
+}
+
+void yuji_token_array_push(YujiTokenArray* tokens, YujiToken token) {
+  if (tokens->size == tokens->capacity) {
+    tokens->capacity = tokens->capacity ? tokens->capacity * 2 : 64;
+    tokens->data = yuji_realloc(tokens->data, sizeof(YujiToken) * tokens->capacity);
+  }
+
+  tokens->data[tokens->size++] = token;
+}
+
+bool yuji_token_is(const YujiToken* token, const char* text) {
+  return strlen(text) == token->length && memcmp(token->start, text, token->length) == 0;
+}
+
+char* yuji_token_strdup(const YujiToken* token) {
+  return strndup(token->start, token->length);
 }
 
 const char* yuji_token_to_string(const YujiToken* token) {
@@ -78,7 +98,7 @@ const char* yuji_token_to_string(const YujiToken* token) {
 
   yuji_string_append_cstr(str, "YujiToken {");
   yuji_string_append_cstr(str, ".value=\"");
-  yuji_string_append_cstr(str, token->value);
+  yuji_string_append(str, token->start, token->length);
   yuji_string_append_cstr(str, "\", .type=");
   yuji_string_append_cstr(str, yuji_token_type_to_string(token->type));
   yuji_string_append_cstr(str, ", .position=\"");
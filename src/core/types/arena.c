@@ -0,0 +1,107 @@
+#include "yuji/core/types/arena.h"
+#include "yuji/core/memory.h"
+#include <string.h>
+
+static YujiArenaChunk* arena_chunk_init(size_t size) {
+  YujiArenaChunk* chunk = yuji_malloc(sizeof(YujiArenaChunk) + size);
+
+  chunk->next = NULL;
+  chunk->size = size;
+  chunk->used = 0;
+
+  return chunk;
+}
+
+static char* arena_chunk_data(YujiArenaChunk* chunk) {
+  return (char*)(chunk + 1);
+}
+
+YujiArena* yuji_arena_init() {
+  YujiArena* arena = yuji_malloc(sizeof(YujiArena));
+
+  arena->chunks = NULL;
+  arena->allocated = 0;
+  arena->refcount = 1;
+
+  return arena;
+}
+
+void yuji_arena_free(YujiArena* arena) {
+  if (--arena->refcount != 0) {
+    return;
+  }
+
+  YujiArenaChunk* chunk = arena->chunks;
+
+  while (chunk) {
+    YujiArenaChunk* next = chunk->next;
+    yuji_free(chunk);
+    chunk = next;
+  }
+
+  yuji_free(arena);
+}
+
+void* yuji_arena_alloc(YujiArena* arena, size_t size) {
+  size = (size + YUJI_ARENA_ALIGNMENT - 1) & ~(size_t)(YUJI_ARENA_ALIGNMENT - 1);
+  arena->allocated += size;
+
+  YujiArenaChunk* chunk = arena->chunks;
+
+  if (chunk && chunk->size - chunk->used >= size) {
+    void* ptr = arena_chunk_data(chunk) + chunk->used;
+    chunk->used += size;
+    return ptr;
+  }
+
+  // big blocks get a chunk of their own behind the current one, so the space
+  // left in the current chunk is not thrown away
+  if (size > YUJI_ARENA_CHUNK_SIZE / 4) {
+    YujiArenaChunk* big = arena_chunk_init(size);
+    big->used = size;
+
+    if (chunk) {
+      big->next = chunk->next;
+      chunk->next = big;
+    } else {
+      arena->chunks = big;
+    }
+
+    return arena_chunk_data(big);
+  }
+
+  chunk = arena_chunk_init(YUJI_ARENA_CHUNK_SIZE);
+  chunk->next = arena->chunks;
+  chunk->used = size;
+  arena->chunks = chunk;
+
+  return arena_chunk_data(chunk);
+}
+
+char* yuji_arena_strndup(YujiArena* arena, const char* str, size_t length) {
+  char* copy = yuji_arena_alloc(arena, length + 1);
+
+  memcpy(copy, str, length);
+  copy[length] = '\0';
+
+  return copy;
+}
+
+char* yuji_arena_strdup(YujiArena* arena, const char* str) {
+  return yuji_arena_strndup(arena, str, strlen(str));
+}
+
+YujiDynArray* yuji_arena_dyn_array(YujiArena* arena, YujiDynArray* items) {
+  size_t size = items ? items->size : 0;
+  YujiDynArray* arr = yuji_arena_alloc(arena, sizeof(YujiDynArray) + sizeof(void*) * size);
+
+  arr->data = (void**)(arr + 1);
+  arr->size = size;
+  arr->capacity = size;
+
+  if (size) {
+    memcpy(arr->data, items->data, sizeof(void*) * size);
+  }
+
+  return arr;
+}
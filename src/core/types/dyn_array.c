@@ -1,10 +1,11 @@
 #include "yuji/core/types/dyn_array.h"
 #include "yuji/core/memory.h"
+#include "yuji/core/pool.h"
 
 #include <stdlib.h>
 
 YujiDynArray* yuji_dyn_array_init() {
-  YujiDynArray* arr = yuji_malloc(sizeof(YujiDynArray));
+  YujiDynArray* arr = yuji_pool_alloc(sizeof(YujiDynArray));
 
   arr->data = yuji_malloc(sizeof(void*) * YUJI_DYN_ARRAY_INITIAL_CAPACITY);
   arr->capacity = YUJI_DYN_ARRAY_INITIAL_CAPACITY;
@@ -15,7 +16,7 @@ YujiDynArray* yuji_dyn_array_init() {
 
 void yuji_dyn_array_free(YujiDynArray *arr) {
   yuji_free(arr->data);
-  yuji_free(arr);
+  yuji_pool_free(arr, sizeof(YujiDynArray));
 }
 
 
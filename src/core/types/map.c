@@ -1,59 +1,153 @@
 #include "yuji/core/types/map.h"
 #include "yuji/core/memory.h"
-#include "yuji/core/types/dyn_array.h"
+#include "yuji/core/symbol.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-YujiMapPair* yuji_map_pair_init(const char* key, void* value) {
-  YujiMapPair* pair = yuji_malloc(sizeof(YujiMapPair));
+// FNV-1a
+static uint32_t map_hash(YujiMap* map, const char* key) {
+  if (map->symbols) {
+    return yuji_symbol_hash(key);
+  }
+
+  uint32_t hash = 2166136261u;
+
+  for (const unsigned char* c = (const unsigned char*)key; *c; c++) {
+    hash ^= *c;
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+static size_t map_find(YujiMap* map, const char* key, uint32_t hash) {
+  if (map->capacity == 0) {
+    return (size_t) -1;
+  }
+
+  size_t mask = map->capacity - 1;
+  size_t index = hash & mask;
+
+  // a slot closer to its home than we are to ours means the key is absent,
+  // robin-hood insertion would have placed it here otherwise
+  for (uint32_t distance = 1;; distance++) {
+    YujiMapPair* pair = &map->pairs[index];
+
+    if (pair->distance < distance) {
+      return (size_t) -1;
+    }
+
+    if (pair->key == key) {
+      return index;
+    }
+
+    if (!map->symbols && pair->hash == hash && strcmp(pair->key, key) == 0) {
+      return index;
+    }
+
+    index = (index + 1) & mask;
+  }
+}
+
+// places a key that is known to be absent, the map must have a free slot
+static void map_place(YujiMap* map, const char* key, void* value, uint32_t hash) {
+  size_t mask = map->capacity - 1;
+  size_t index = hash & mask;
+  YujiMapPair entry = { key, value, hash, 1 };
 
-  pair->key = strdup(key);
-  pair->value = value;
+  for (;;) {
+    YujiMapPair* pair = &map->pairs[index];
 
-  return pair;
+    if (pair->distance == 0) {
+      *pair = entry;
+      map->size++;
+      return;
+    }
+
+    if (pair->distance < entry.distance) {
+      YujiMapPair tmp = *pair;
+      *pair = entry;
+      entry = tmp;
+    }
+
+    index = (index + 1) & mask;
+    entry.distance++;
+  }
 }
 
-void yuji_map_pair_free(YujiMapPair* pair) {
-  yuji_free((void*)pair->key);
-  yuji_free(pair);
+static void map_grow(YujiMap* map) {
+  YujiMapPair* old_pairs = map->pairs;
+  size_t old_capacity = map->capacity;
+
+  map->capacity = old_capacity ? old_capacity * 2 : YUJI_MAP_INITIAL_CAPACITY;
+  map->pairs = yuji_malloc(sizeof(YujiMapPair) * map->capacity);
+  map->size = 0;
+
+  for (size_t i = 0; i < old_capacity; i++) {
+    YujiMapPair* pair = &old_pairs[i];
+
+    if (pair->distance != 0) {
+      map_place(map, pair->key, pair->value, pair->hash);
+    }
+  }
+
+  if (old_pairs) {
+    yuji_free(old_pairs);
+  }
 }
 
 YujiMap* yuji_map_init() {
   YujiMap* map = yuji_malloc(sizeof(YujiMap));
 
-  map->pairs = yuji_dyn_array_init();
+  map->pairs = NULL;
+  map->size = 0;
+  map->capacity = 0;
+  map->symbols = false;
 
   return map;
 }
 
+YujiMap* yuji_map_init_symbols() {
+  YujiMap* map = yuji_map_init();
+  map->symbols = true;
+  return map;
+}
+
+static void map_free_keys(YujiMap* map) {
+  if (map->symbols) {
+    return;
+  }
+
+  YUJI_MAP_ITER(map, pair, {
+    yuji_free((void*)pair->key);
+  })
+}
+
 void yuji_map_free(YujiMap* map) {
   if (map) {
-    for (size_t i = 0; i < map->pairs->size; i++) {
-      YujiMapPair* pair = yuji_dyn_array_get(map->pairs, i);
-      yuji_map_pair_free(pair);
+    map_free_keys(map);
+
+    if (map->pairs) {
+      yuji_free(map->pairs);
     }
 
-    yuji_dyn_array_free(map->pairs);
     yuji_free(map);
   }
 }
 
-void yuji_map_insert(YujiMap* map, const char* key, void* value) {
-  size_t index = yuji_map_index_of(map, key);
-
-  if (index == (size_t) -1) {
-    YujiMapPair* pair = yuji_map_pair_init(key, value);
-
-    if (!pair) {
-      return;
-    }
+void yuji_map_clear(YujiMap* map) {
+  map_free_keys(map);
 
-    yuji_dyn_array_push(map->pairs, pair);
-    return;
+  if (map->pairs) {
+    memset(map->pairs, 0, sizeof(YujiMapPair) * map->capacity);
   }
 
-  YujiMapPair* pair = yuji_dyn_array_get(map->pairs, index);
-  pair->value = value;
+  map->size = 0;
+}
+
+void yuji_map_insert(YujiMap* map, const char* key, void* value) {
+  yuji_map_set(map, key, value);
 }
 
 void yuji_map_remove(YujiMap* map, const char* key) {
@@ -63,48 +157,53 @@ void yuji_map_remove(YujiMap* map, const char* key) {
     return;
   }
 
-  yuji_dyn_array_remove(map->pairs, index);
-}
+  if (!map->symbols) {
+    yuji_free((void*)map->pairs[index].key);
+  }
 
-size_t yuji_map_index_of(YujiMap *map, const char* key) {
-  for (size_t i = 0; i < map->pairs->size; i++) {
-    YujiMapPair* pair = yuji_dyn_array_get(map->pairs, i);
+  // backward-shift deletion: pull the following displaced slots one step
+  // closer to their home instead of leaving a tombstone behind
+  size_t mask = map->capacity - 1;
+  size_t next = (index + 1) & mask;
 
-    if (strcmp(pair->key, key) == 0) {
-      return i;
-    }
+  while (map->pairs[next].distance > 1) {
+    map->pairs[index] = map->pairs[next];
+    map->pairs[index].distance--;
+    index = next;
+    next = (next + 1) & mask;
   }
 
-  return (size_t) -1;
+  memset(&map->pairs[index], 0, sizeof(YujiMapPair));
+  map->size--;
 }
 
+size_t yuji_map_index_of(YujiMap* map, const char* key) {
+  return map_find(map, key, map_hash(map, key));
+}
 
 void* yuji_map_get(YujiMap* map, const char* key) {
-  for (size_t i = 0; i < map->pairs->size; i++) {
-    YujiMapPair* pair = yuji_dyn_array_get(map->pairs, i);
+  size_t index = map_find(map, key, map_hash(map, key));
 
-    if (strcmp(pair->key, key) == 0) {
-      return pair->value;
-    }
+  if (index == (size_t) -1) {
+    return NULL;
   }
 
-  return NULL;
+  return map->pairs[index].value;
 }
 
 void yuji_map_set(YujiMap* map, const char* key, void* value) {
-  size_t index = yuji_map_index_of(map, key);
-
-  if (index == (size_t) -1) {
-    YujiMapPair* pair = yuji_map_pair_init(key, value);
-
-    if (!pair) {
-      return;
-    }
+  uint32_t hash = map_hash(map, key);
+  size_t index = map_find(map, key, hash);
 
-    yuji_dyn_array_push(map->pairs, pair);
+  if (index != (size_t) -1) {
+    map->pairs[index].value = value;
     return;
   }
 
-  YujiMapPair* pair = yuji_dyn_array_get(map->pairs, index);
-  pair->value = value;
+  // keep the load factor below 7/8
+  if ((map->size + 1) * 8 > map->capacity * 7) {
+    map_grow(map);
+  }
+
+  map_place(map, map->symbols ? key : strdup(key), value, hash);
 }
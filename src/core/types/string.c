@@ -1,68 +1,181 @@
 #include "yuji/core/memory.h"
+#include "yuji/core/pool.h"
 #include "yuji/core/types/dyn_array.h"
+#include <string.h>
 #include <yuji/core/types/string.h>
 
 YujiString* yuji_string_init() {
-  YujiString* str = yuji_malloc(sizeof(YujiString));
+  YujiString* str = yuji_pool_alloc(sizeof(YujiString));
 
-  str->capacity = 16;
+  str->data = str->storage.inline_;
   str->size = 0;
-  str->data = yuji_malloc(str->capacity);
   str->data[0] = '\0';
 
   return str;
 }
 
 YujiString* yuji_string_init_from_cstr(const char* cstr) {
+  return yuji_string_init_from_buffer(cstr, strlen(cstr));
+}
+
+YujiString* yuji_string_init_from_buffer(const char* buf, size_t len) {
   YujiString* str = yuji_string_init();
+  yuji_string_append(str, buf, len);
+  return str;
+}
+
+YujiString* yuji_string_adopt(char* data, size_t len) {
+  YujiString* str = yuji_pool_alloc(sizeof(YujiString));
+
+  str->data = data;
+  str->size = len;
+  str->storage.capacity = len + 1;
+
+  return str;
+}
+
+YujiString* yuji_string_init_shared(const char* data, size_t len, YujiArena* owner) {
+  YujiString* str = yuji_pool_alloc(sizeof(YujiString));
 
-  while (*cstr) {
-    yuji_string_append_char(str, *cstr++);
+  str->data = (char*)data;
+  str->size = len;
+  str->storage.capacity = 0;
+  str->storage.owner = owner;
+
+  if (owner) {
+    owner->refcount++;
   }
 
   return str;
 }
 
+YujiString* yuji_string_share(YujiString* str) {
+  if (yuji_string_is_shared(str)) {
+    return yuji_string_init_shared(str->data, str->size, str->storage.owner);
+  }
+
+  return yuji_string_init_from_buffer(str->data, str->size);
+}
+
+// drops the reference to a shared buffer, the caller has copied what it needs
+static void string_release_shared(YujiString* str) {
+  if (str->storage.owner) {
+    yuji_arena_free(str->storage.owner);
+  }
+}
+
 void yuji_string_free(YujiString* str) {
-  yuji_free(str->data);
-  yuji_free(str);
+  if (yuji_string_is_shared(str)) {
+    string_release_shared(str);
+  } else if (!yuji_string_is_inline(str)) {
+    yuji_free(str->data);
+  }
+
+  yuji_pool_free(str, sizeof(YujiString));
 }
 
-void yuji_string_append_char(YujiString* str, char char_) {
-  if (str->size + 2 > str->capacity) {
-    str->capacity *= 2;
-    str->data = yuji_realloc(str->data, str->capacity);
+char* yuji_string_detach(YujiString* str) {
+  char* data = str->data;
+
+  if (yuji_string_is_inline(str) || yuji_string_is_shared(str)) {
+    data = yuji_malloc(str->size + 1);
+    memcpy(data, str->data, str->size + 1);
+  }
+
+  if (yuji_string_is_shared(str)) {
+    string_release_shared(str);
   }
 
+  yuji_pool_free(str, sizeof(YujiString));
+  return data;
+}
+
+void yuji_string_reserve(YujiString* str, size_t size) {
+  size_t capacity = yuji_string_capacity(str);
+
+  if (size + 1 <= capacity) {
+    return;
+  }
+
+  // grow geometrically so that appending byte by byte stays amortized O(1)
+  capacity *= 2;
+
+  if (capacity < size + 1) {
+    capacity = size + 1;
+  }
+
+  if (capacity < YUJI_STRING_INLINE_CAPACITY) {
+    capacity = YUJI_STRING_INLINE_CAPACITY;
+  }
+
+  // writing to a shared buffer copies it first
+  if (yuji_string_is_inline(str) || yuji_string_is_shared(str)) {
+    char* data = yuji_malloc(capacity);
+    memcpy(data, str->data, str->size + 1);
+
+    if (yuji_string_is_shared(str)) {
+      string_release_shared(str);
+    }
+
+    str->data = data;
+  } else {
+    str->data = yuji_realloc(str->data, capacity);
+  }
+
+  str->storage.capacity = capacity;
+}
+
+void yuji_string_shrink(YujiString* str) {
+  if (yuji_string_is_inline(str) || yuji_string_is_shared(str) ||
+      str->storage.capacity == str->size + 1) {
+    return;
+  }
+
+  if (str->size < YUJI_STRING_INLINE_CAPACITY) {
+    char* data = str->data;
+    memcpy(str->storage.inline_, data, str->size + 1);
+    str->data = str->storage.inline_;
+    yuji_free(data);
+    return;
+  }
+
+  str->data = yuji_realloc(str->data, str->size + 1);
+  str->storage.capacity = str->size + 1;
+}
+
+void yuji_string_append_char(YujiString* str, char char_) {
+  yuji_string_reserve(str, str->size + 1);
+
   str->data[str->size++] = char_;
   str->data[str->size] = '\0';
 }
 
 void yuji_string_append_cstr(YujiString* str, const char* cstr) {
-  while (*cstr) {
-    yuji_string_append_char(str, *cstr++);
-  }
+  yuji_string_append(str, cstr, strlen(cstr));
+}
+
+void yuji_string_append(YujiString* str, const char* buf, size_t len) {
+  yuji_string_reserve(str, str->size + len);
+
+  memcpy(str->data + str->size, buf, len);
+  str->size += len;
+  str->data[str->size] = '\0';
 }
 
 YujiDynArray* yuji_string_split(YujiString* str, char delim) {
   YujiDynArray* result = yuji_dyn_array_init();
-  YujiString* buf = yuji_string_init();
-
-  for (size_t i = 0; i < str->size; ++i) {
-    if (str->data[i] == delim) {
-      yuji_dyn_array_push(result, buf);
-      buf = yuji_string_init();
-    } else {
-      yuji_string_append_char(buf, str->data[i]);
-    }
-  }
+  const char* start = str->data;
+  const char* end = str->data + str->size;
 
-  yuji_dyn_array_push(result, buf);
-  return result;
-}
+  for (;;) {
+    const char* found = memchr(start, delim, (size_t)(end - start));
 
-void yuji_string_append(YujiString* str, const char* buf, size_t len) {
-  for (size_t i = 0; i < len; i++) {
-    yuji_string_append_char(str, buf[i]);
+    if (!found) {
+      yuji_dyn_array_push(result, yuji_string_init_from_buffer(start, (size_t)(end - start)));
+      return result;
+    }
+
+    yuji_dyn_array_push(result, yuji_string_init_from_buffer(start, (size_t)(found - start)));
+    start = found + 1;
   }
 }
@@ -1,6 +1,8 @@
 #include "yuji/core/value.h"
 #include "yuji/core/ast.h"
+#include "yuji/core/bytecode.h"
 #include "yuji/core/memory.h"
+#include "yuji/core/types/arena.h"
 #include "yuji/core/types/dyn_array.h"
 #include "yuji/core/types/string.h"
 #include <stdio.h>
@@ -9,11 +11,11 @@
 void yuji_value_free(YujiValue* value) {
   yuji_check_memory(value);
 
-  if (--value->refcount != 0) {
+  if (!yuji_value_is_heap(value) || --value->refcount != 0) {
     return;
   }
 
-  switch (value->type) {
+  switch (yuji_value_type(value)) {
     case VT_INT:
     case VT_FLOAT:
     case VT_BOOL:
@@ -21,18 +23,17 @@ void yuji_value_free(YujiValue* value) {
       break;
 
     case VT_FUNCTION: {
-      YujiASTNode* wrapper = yuji_malloc(sizeof(YujiASTNode));
-      wrapper->type = YUJI_AST_FN;
-      wrapper->value.fn = value->value.function.node;
-      yuji_ast_free(wrapper);
+      if (value->value.function.proto) {
+        yuji_proto_free(value->value.function.proto);
+        break;
+      }
+
+      yuji_arena_free(value->value.function.node->arena);
       break;
     }
 
     case VT_ARRAY:
-      YUJI_DYN_ARRAY_ITER(value->value.array, YujiValue, element, {
-        yuji_value_free(element);
-      })
-      yuji_dyn_array_free(value->value.array);
+      yuji_array_free(value->value.array);
       break;
 
     case VT_STRING:
@@ -44,19 +45,19 @@ void yuji_value_free(YujiValue* value) {
       break;
   }
 
-  yuji_free(value);
+  yuji_pool_free(value, sizeof(YujiValue));
 }
 
 bool yuji_value_to_bool(YujiValue* value) {
-  switch (value->type) {
+  switch (yuji_value_type(value)) {
     case VT_INT:
-      return value->value.int_ != 0;
+      return yuji_value_as_int(value) != 0;
 
     case VT_FLOAT:
-      return value->value.float_ != 0.0;
+      return yuji_value_as_float(value) != 0.0;
 
     case VT_BOOL:
-      return value->value.bool_;
+      return yuji_value_as_bool(value);
 
     case VT_STRING:
       return value->value.string->size > 0;
@@ -71,17 +72,18 @@ char* yuji_value_to_string(YujiValue* value) {
 
   char* result = NULL;
 
-  switch (value->type) {
+  switch (yuji_value_type(value)) {
     case VT_INT: {
-      size_t len = (size_t)snprintf(NULL, 0, "%lld", (long long)value->value.int_);
+      long long number = (long long)yuji_value_as_int(value);
+      size_t len = (size_t)snprintf(NULL, 0, "%lld", number);
       result = yuji_malloc(len + 1);
-      snprintf(result, len + 1, "%lld", (long long)value->value.int_);
+      snprintf(result, len + 1, "%lld", number);
       break;
     }
 
     case VT_FLOAT: {
       char buf[64];
-      snprintf(buf, sizeof(buf), "%.15f", value->value.float_);
+      snprintf(buf, sizeof(buf), "%.15f", yuji_value_as_float(value));
       char* end = buf + strlen(buf) - 1;
 
       while (end > buf && *end == '0') {
@@ -101,12 +103,12 @@ char* yuji_value_to_string(YujiValue* value) {
 
     case VT_STRING:
       result = yuji_malloc(value->value.string->size + 1);
-      strcpy(result, value->value.string->data);
+      memcpy(result, value->value.string->data, value->value.string->size + 1);
       break;
 
     case VT_BOOL:
-      result = yuji_malloc((value->value.bool_ ? strlen("true") : strlen("false")) + 1);
-      strcpy(result, value->value.bool_ ? "true" : "false");
+      result = yuji_malloc((yuji_value_as_bool(value) ? strlen("true") : strlen("false")) + 1);
+      strcpy(result, yuji_value_as_bool(value) ? "true" : "false");
       break;
 
     case VT_NULL:
@@ -116,7 +118,9 @@ char* yuji_value_to_string(YujiValue* value) {
 
     case VT_FUNCTION:
       result = yuji_malloc(32);
-      snprintf(result, 32, "<function:%p>", (void*)value->value.function.node);
+      snprintf(result, 32, "<function:%p>", value->value.function.proto
+               ? (void*)value->value.function.proto
+               : (void*)value->value.function.node);
       break;
 
     case VT_CFUNCTION:
@@ -125,28 +129,26 @@ char* yuji_value_to_string(YujiValue* value) {
       break;
 
     case VT_ARRAY: {
-      YujiDynArray* array = value->value.array;
+      YujiArray* array = value->value.array;
       YujiString* str = yuji_string_init();
 
       yuji_string_append_cstr(str, "[");
 
-      size_t i = 0;
-      YUJI_DYN_ARRAY_ITER(array, YujiValue, element, {
+      for (size_t i = 0; i < array->size; i++) {
+        YujiValue* element = yuji_array_get(array, i);
         char* element_str = yuji_value_to_string(element);
         yuji_string_append_cstr(str, element_str);
         yuji_free(element_str);
+        yuji_value_free(element);
 
         if (i < array->size - 1) {
           yuji_string_append_cstr(str, ", ");
         }
-        i++;
-      })
+      }
 
       yuji_string_append_cstr(str, "]");
 
-      result = yuji_malloc(str->size + 1);
-      strcpy(result, str->data);
-      yuji_string_free(str);
+      result = yuji_string_detach(str);
       break;
     }
   }
@@ -188,25 +190,31 @@ bool yuji_value_type_is(YujiValueType type, YujiValueType expected) {
   return type == expected;
 }
 
-YUJI_VALUE_INIT(int, VT_INT, {
+YUJI_VALUE_INIT(boxed_int, VT_INT, {
   value->value.int_ = number;
 }, int64_t number)
 
-YUJI_VALUE_INIT(float, VT_FLOAT, {
+YUJI_VALUE_INIT(boxed_float, VT_FLOAT, {
   value->value.float_ = number;
 }, double number)
 
 YUJI_VALUE_INIT(function, VT_FUNCTION, {
-  YujiASTNode* fn_node = yuji_ast_fn_init(node->name, node->params, node->body->value.block);
-  value->value.function.node = fn_node->value.fn;
-  yuji_free(fn_node);
+  node->arena->refcount++;
+  value->value.function.node = node;
 }, YujiASTFunction* node)
 
+YUJI_VALUE_INIT(proto, VT_FUNCTION, {
+  proto->refcount++;
+  value->value.function.proto = proto;
+}, YujiProto* proto)
+
 YUJI_VALUE_INIT(string, VT_STRING, {
-  value->value.string = yuji_string_init_from_cstr(string->data);
+  value->value.string = yuji_string_share(string);
 }, YujiString* string)
 
-YUJI_VALUE_INIT(null, VT_NULL, {})
+YUJI_VALUE_INIT(string_adopt, VT_STRING, {
+  value->value.string = string;
+}, YujiString* string)
 
 YUJI_VALUE_INIT(cfunction, VT_CFUNCTION, {
   YujiCFunction* cfunction = yuji_malloc(sizeof(YujiCFunction));
@@ -217,10 +225,6 @@ YUJI_VALUE_INIT(cfunction, VT_CFUNCTION, {
 
 }, size_t argc, YujiValue * (*func)(struct YujiScope* scope, YujiDynArray* args))
 
-YUJI_VALUE_INIT(bool, VT_BOOL, {
-  value->value.bool_ = bool_;
-}, bool bool_)
-
 YUJI_VALUE_INIT(array, VT_ARRAY, {
   value->value.array = array;
-}, YujiDynArray* array)
+}, YujiArray* array)
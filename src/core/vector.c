@@ -0,0 +1,886 @@
+#include "yuji/core/vector.h"
+#include "yuji/core/memory.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define YUJI_VECTOR_X86 1
+#include <immintrin.h>
+#endif
+
+#define LANES 8
+
+typedef struct {
+  const char* name;
+  bool (*sum_int)(const int64_t* data, size_t size, int64_t* result);
+  double (*sum_float)(const double* data, size_t size);
+  int64_t (*min_int)(const int64_t* data, size_t size);
+  int64_t (*max_int)(const int64_t* data, size_t size);
+  double (*min_float)(const double* data, size_t size);
+  double (*max_float)(const double* data, size_t size);
+  double (*dot_float)(const double* left, const double* right, size_t size);
+  void (*scale_float)(double* out, const double* data, double factor, size_t size);
+  bool (*add_int)(int64_t* out, const int64_t* left, const int64_t* right, size_t size);
+  void (*add_float)(double* out, const double* left, const double* right, size_t size);
+  void (*fill)(uint64_t* out, uint64_t bits, size_t size);
+  void (*range)(int64_t* out, int64_t start, int64_t step, size_t size);
+  void (*compare_int)(uint64_t* out, const int64_t* left, const int64_t* right, size_t size,
+                      YujiOperator op, uint64_t if_true, uint64_t if_false);
+  void (*compare_float)(uint64_t* out, const double* left, const double* right, size_t size,
+                        YujiOperator op, uint64_t if_true, uint64_t if_false);
+} YujiVectorKernels;
+
+// same operand order as minpd/maxpd, which return the second operand when
+// the comparison is false
+static double float_min(double left, double right) {
+  return left < right ? left : right;
+}
+
+static double float_max(double left, double right) {
+  return left > right ? left : right;
+}
+
+static double float_add(double left, double right) {
+  return left + right;
+}
+
+static double lanes_reduce(const double* lanes, double (*combine)(double, double)) {
+  return combine(combine(combine(lanes[0], lanes[1]), combine(lanes[2], lanes[3])),
+                 combine(combine(lanes[4], lanes[5]), combine(lanes[6], lanes[7])));
+}
+
+static bool compare_int(YujiOperator op, int64_t left, int64_t right) {
+  switch (op) {
+    case YUJI_OPERATOR_LT:
+      return left < right;
+    case YUJI_OPERATOR_GT:
+      return left > right;
+    case YUJI_OPERATOR_LTE:
+      return left <= right;
+    case YUJI_OPERATOR_GTE:
+      return left >= right;
+    case YUJI_OPERATOR_EQ:
+      return left == right;
+    case YUJI_OPERATOR_NEQ:
+      return left != right;
+    default:
+      yuji_panic("%s is not a comparison", yuji_operator_to_string(op));
+  }
+}
+
+static bool compare_float(YujiOperator op, double left, double right) {
+  switch (op) {
+    case YUJI_OPERATOR_LT:
+      return left < right;
+    case YUJI_OPERATOR_GT:
+      return left > right;
+    case YUJI_OPERATOR_LTE:
+      return left <= right;
+    case YUJI_OPERATOR_GTE:
+      return left >= right;
+    case YUJI_OPERATOR_EQ:
+      return left == right;
+    case YUJI_OPERATOR_NEQ:
+      return left != right;
+    default:
+      yuji_panic("%s is not a comparison", yuji_operator_to_string(op));
+  }
+}
+
+// scalar kernels, also used for the tails the vector kernels leave over
+
+// exact, only the final sum has to fit, whatever order the vector kernels
+// add the elements in
+static bool scalar_sum_int(const int64_t* data, size_t size, int64_t* result) {
+  __int128 sum = 0;
+
+  for (size_t i = 0; i < size; i++) {
+    sum += data[i];
+  }
+
+  if (sum < INT64_MIN || sum > INT64_MAX) {
+    return false;
+  }
+
+  *result = (int64_t)sum;
+  return true;
+}
+
+static double scalar_sum_float(const double* data, size_t size) {
+  double lanes[LANES] = {0};
+  size_t i = 0;
+
+  for (; i + LANES <= size; i += LANES) {
+    for (size_t lane = 0; lane < LANES; lane++) {
+      lanes[lane] += data[i + lane];
+    }
+  }
+
+  double sum = lanes_reduce(lanes, float_add);
+
+  for (; i < size; i++) {
+    sum += data[i];
+  }
+
+  return sum;
+}
+
+static int64_t scalar_min_int(const int64_t* data, size_t size) {
+  int64_t min = data[0];
+
+  for (size_t i = 1; i < size; i++) {
+    min = data[i] < min ? data[i] : min;
+  }
+
+  return min;
+}
+
+static int64_t scalar_max_int(const int64_t* data, size_t size) {
+  int64_t max = data[0];
+
+  for (size_t i = 1; i < size; i++) {
+    max = data[i] > max ? data[i] : max;
+  }
+
+  return max;
+}
+
+static double scalar_fold_float(const double* data, size_t size, double (*combine)(double, double)) {
+  if (size < LANES) {
+    double result = data[0];
+
+    for (size_t i = 1; i < size; i++) {
+      result = combine(result, data[i]);
+    }
+
+    return result;
+  }
+
+  double lanes[LANES];
+  memcpy(lanes, data, sizeof(lanes));
+  size_t i = LANES;
+
+  for (; i + LANES <= size; i += LANES) {
+    for (size_t lane = 0; lane < LANES; lane++) {
+      lanes[lane] = combine(lanes[lane], data[i + lane]);
+    }
+  }
+
+  double result = lanes_reduce(lanes, combine);
+
+  for (; i < size; i++) {
+    result = combine(result, data[i]);
+  }
+
+  return result;
+}
+
+static double scalar_min_float(const double* data, size_t size) {
+  return scalar_fold_float(data, size, float_min);
+}
+
+static double scalar_max_float(const double* data, size_t size) {
+  return scalar_fold_float(data, size, float_max);
+}
+
+static double scalar_dot_float(const double* left, const double* right, size_t size) {
+  double lanes[LANES] = {0};
+  size_t i = 0;
+
+  for (; i + LANES <= size; i += LANES) {
+    for (size_t lane = 0; lane < LANES; lane++) {
+      lanes[lane] += left[i + lane] * right[i + lane];
+    }
+  }
+
+  double sum = lanes_reduce(lanes, float_add);
+
+  for (; i < size; i++) {
+    sum += left[i] * right[i];
+  }
+
+  return sum;
+}
+
+static void scalar_scale_float(double* out, const double* data, double factor, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    out[i] = data[i] * factor;
+  }
+}
+
+static bool scalar_add_int(int64_t* out, const int64_t* left, const int64_t* right, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    if (__builtin_add_overflow(left[i], right[i], &out[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void scalar_add_float(double* out, const double* left, const double* right, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    out[i] = left[i] + right[i];
+  }
+}
+
+static void scalar_fill(uint64_t* out, uint64_t bits, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    out[i] = bits;
+  }
+}
+
+static void scalar_range(int64_t* out, int64_t start, int64_t step, size_t size) {
+  // wraps like the vector kernels, the caller guarantees the values fit
+  for (size_t i = 0; i < size; i++) {
+    out[i] = (int64_t)((uint64_t)start + (uint64_t)i * (uint64_t)step);
+  }
+}
+
+static void scalar_compare_int(uint64_t* out, const int64_t* left, const int64_t* right, size_t size,
+                               YujiOperator op, uint64_t if_true, uint64_t if_false) {
+  for (size_t i = 0; i < size; i++) {
+    out[i] = compare_int(op, left[i], right[i]) ? if_true : if_false;
+  }
+}
+
+static void scalar_compare_float(uint64_t* out, const double* left, const double* right, size_t size,
+                                 YujiOperator op, uint64_t if_true, uint64_t if_false) {
+  for (size_t i = 0; i < size; i++) {
+    out[i] = compare_float(op, left[i], right[i]) ? if_true : if_false;
+  }
+}
+
+static const YujiVectorKernels SCALAR_KERNELS = {
+  .name = "scalar",
+  .sum_int = scalar_sum_int,
+  .sum_float = scalar_sum_float,
+  .min_int = scalar_min_int,
+  .max_int = scalar_max_int,
+  .min_float = scalar_min_float,
+  .max_float = scalar_max_float,
+  .dot_float = scalar_dot_float,
+  .scale_float = scalar_scale_float,
+  .add_int = scalar_add_int,
+  .add_float = scalar_add_float,
+  .fill = scalar_fill,
+  .range = scalar_range,
+  .compare_int = scalar_compare_int,
+  .compare_float = scalar_compare_float,
+};
+
+#ifdef YUJI_VECTOR_X86
+
+// SSE2 is part of x86-64, so these need no target attribute. it has no
+// 64-bit integer comparisons, the integer min, max and compare kernels stay
+// scalar
+
+// sign bit set in a lane where adding `left` and `right` gave `sum` overflowed
+#define _YUJI_ADD_OVERFLOW(XOR, AND, LEFT, RIGHT, SUM) AND(XOR(LEFT, SUM), XOR(RIGHT, SUM))
+
+static bool sse2_sum_int(const int64_t* data, size_t size, int64_t* result) {
+  __m128i acc = _mm_setzero_si128();
+  __m128i overflow = _mm_setzero_si128();
+  size_t i = 0;
+
+  for (; i + 2 <= size; i += 2) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(data + i));
+    __m128i sum = _mm_add_epi64(acc, x);
+    overflow = _mm_or_si128(overflow, _YUJI_ADD_OVERFLOW(_mm_xor_si128, _mm_and_si128, acc, x, sum));
+    acc = sum;
+  }
+
+  if (_mm_movemask_pd(_mm_castsi128_pd(overflow))) {
+    return false;
+  }
+
+  int64_t lanes[3];
+  _mm_storeu_si128((__m128i*)lanes, acc);
+  lanes[2] = size > i ? data[i] : 0;
+
+  return scalar_sum_int(lanes, 3, result);
+}
+
+static double sse2_sum_float(const double* data, size_t size) {
+  __m128d acc[4] = {_mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd()};
+  size_t i = 0;
+
+  for (; i + LANES <= size; i += LANES) {
+    for (size_t reg = 0; reg < 4; reg++) {
+      acc[reg] = _mm_add_pd(acc[reg], _mm_loadu_pd(data + i + reg * 2));
+    }
+  }
+
+  double lanes[LANES];
+
+  for (size_t reg = 0; reg < 4; reg++) {
+    _mm_storeu_pd(lanes + reg * 2, acc[reg]);
+  }
+
+  double sum = lanes_reduce(lanes, float_add);
+
+  for (; i < size; i++) {
+    sum += data[i];
+  }
+
+  return sum;
+}
+
+#define _YUJI_SSE2_FOLD_FLOAT(NAME, INTRINSIC, COMBINE) \
+  static double sse2_##NAME##_float(const double* data, size_t size) { \
+    if (size < LANES) { \
+      return scalar_fold_float(data, size, COMBINE); \
+    } \
+    __m128d acc[4]; \
+    for (size_t reg = 0; reg < 4; reg++) { \
+      acc[reg] = _mm_loadu_pd(data + reg * 2); \
+    } \
+    size_t i = LANES; \
+    for (; i + LANES <= size; i += LANES) { \
+      for (size_t reg = 0; reg < 4; reg++) { \
+        acc[reg] = INTRINSIC(acc[reg], _mm_loadu_pd(data + i + reg * 2)); \
+      } \
+    } \
+    double lanes[LANES]; \
+    for (size_t reg = 0; reg < 4; reg++) { \
+      _mm_storeu_pd(lanes + reg * 2, acc[reg]); \
+    } \
+    double result = lanes_reduce(lanes, COMBINE); \
+    for (; i < size; i++) { \
+      result = COMBINE(result, data[i]); \
+    } \
+    return result; \
+  }
+
+_YUJI_SSE2_FOLD_FLOAT(min, _mm_min_pd, float_min)
+_YUJI_SSE2_FOLD_FLOAT(max, _mm_max_pd, float_max)
+
+static double sse2_dot_float(const double* left, const double* right, size_t size) {
+  __m128d acc[4] = {_mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd()};
+  size_t i = 0;
+
+  for (; i + LANES <= size; i += LANES) {
+    for (size_t reg = 0; reg < 4; reg++) {
+      __m128d product = _mm_mul_pd(_mm_loadu_pd(left + i + reg * 2), _mm_loadu_pd(right + i + reg * 2));
+      acc[reg] = _mm_add_pd(acc[reg], product);
+    }
+  }
+
+  double lanes[LANES];
+
+  for (size_t reg = 0; reg < 4; reg++) {
+    _mm_storeu_pd(lanes + reg * 2, acc[reg]);
+  }
+
+  double sum = lanes_reduce(lanes, float_add);
+
+  for (; i < size; i++) {
+    sum += left[i] * right[i];
+  }
+
+  return sum;
+}
+
+static void sse2_scale_float(double* out, const double* data, double factor, size_t size) {
+  __m128d scale = _mm_set1_pd(factor);
+  size_t i = 0;
+
+  for (; i + 2 <= size; i += 2) {
+    _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(data + i), scale));
+  }
+
+  scalar_scale_float(out + i, data + i, factor, size - i);
+}
+
+static bool sse2_add_int(int64_t* out, const int64_t* left, const int64_t* right, size_t size) {
+  __m128i overflow = _mm_setzero_si128();
+  size_t i = 0;
+
+  for (; i + 2 <= size; i += 2) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(left + i));
+    __m128i y = _mm_loadu_si128((const __m128i*)(right + i));
+    __m128i sum = _mm_add_epi64(x, y);
+    overflow = _mm_or_si128(overflow, _YUJI_ADD_OVERFLOW(_mm_xor_si128, _mm_and_si128, x, y, sum));
+    _mm_storeu_si128((__m128i*)(out + i), sum);
+  }
+
+  if (_mm_movemask_pd(_mm_castsi128_pd(overflow))) {
+    return false;
+  }
+
+  return scalar_add_int(out + i, left + i, right + i, size - i);
+}
+
+static void sse2_add_float(double* out, const double* left, const double* right, size_t size) {
+  size_t i = 0;
+
+  for (; i + 2 <= size; i += 2) {
+    _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(left + i), _mm_loadu_pd(right + i)));
+  }
+
+  scalar_add_float(out + i, left + i, right + i, size - i);
+}
+
+static void sse2_fill(uint64_t* out, uint64_t bits, size_t size) {
+  __m128i value = _mm_set1_epi64x((long long)bits);
+  size_t i = 0;
+
+  for (; i + 2 <= size; i += 2) {
+    _mm_storeu_si128((__m128i*)(out + i), value);
+  }
+
+  scalar_fill(out + i, bits, size - i);
+}
+
+static void sse2_range(int64_t* out, int64_t start, int64_t step, size_t size) {
+  __m128i value = _mm_set_epi64x((long long)((uint64_t)start + (uint64_t)step), (long long)start);
+  __m128i increment = _mm_set1_epi64x((long long)((uint64_t)step * 2));
+  size_t i = 0;
+
+  for (; i + 2 <= size; i += 2) {
+    _mm_storeu_si128((__m128i*)(out + i), value);
+    value = _mm_add_epi64(value, increment);
+  }
+
+  scalar_range(out + i, (int64_t)((uint64_t)start + (uint64_t)i * (uint64_t)step), step, size - i);
+}
+
+#define _YUJI_SSE2_COMPARE_LOOP(INTRINSIC) \
+  for (; i + 2 <= size; i += 2) { \
+    __m128d mask = INTRINSIC(_mm_loadu_pd(left + i), _mm_loadu_pd(right + i)); \
+    __m128i result = _mm_xor_si128(no, _mm_and_si128(_mm_castpd_si128(mask), flip)); \
+    _mm_storeu_si128((__m128i*)(out + i), result); \
+  }
+
+static void sse2_compare_float(uint64_t* out, const double* left, const double* right, size_t size,
+                               YujiOperator op, uint64_t if_true, uint64_t if_false) {
+  // if_false, with the bits that differ from if_true flipped where the mask is set
+  __m128i no = _mm_set1_epi64x((long long)if_false);
+  __m128i flip = _mm_set1_epi64x((long long)(if_true ^ if_false));
+  size_t i = 0;
+
+  switch (op) {
+    case YUJI_OPERATOR_LT:
+      _YUJI_SSE2_COMPARE_LOOP(_mm_cmplt_pd)
+      break;
+    case YUJI_OPERATOR_GT:
+      _YUJI_SSE2_COMPARE_LOOP(_mm_cmpgt_pd)
+      break;
+    case YUJI_OPERATOR_LTE:
+      _YUJI_SSE2_COMPARE_LOOP(_mm_cmple_pd)
+      break;
+    case YUJI_OPERATOR_GTE:
+      _YUJI_SSE2_COMPARE_LOOP(_mm_cmpge_pd)
+      break;
+    case YUJI_OPERATOR_EQ:
+      _YUJI_SSE2_COMPARE_LOOP(_mm_cmpeq_pd)
+      break;
+    case YUJI_OPERATOR_NEQ:
+      _YUJI_SSE2_COMPARE_LOOP(_mm_cmpneq_pd)
+      break;
+    default:
+      break;
+  }
+
+  scalar_compare_float(out + i, left + i, right + i, size - i, op, if_true, if_false);
+}
+
+static const YujiVectorKernels SSE2_KERNELS = {
+  .name = "sse2",
+  .sum_int = sse2_sum_int,
+  .sum_float = sse2_sum_float,
+  .min_int = scalar_min_int,
+  .max_int = scalar_max_int,
+  .min_float = sse2_min_float,
+  .max_float = sse2_max_float,
+  .dot_float = sse2_dot_float,
+  .scale_float = sse2_scale_float,
+  .add_int = sse2_add_int,
+  .add_float = sse2_add_float,
+  .fill = sse2_fill,
+  .range = sse2_range,
+  .compare_int = scalar_compare_int,
+  .compare_float = sse2_compare_float,
+};
+
+#define _YUJI_AVX2 __attribute__((target("avx2")))
+
+_YUJI_AVX2 static bool avx2_sum_int(const int64_t* data, size_t size, int64_t* result) {
+  __m256i acc = _mm256_setzero_si256();
+  __m256i overflow = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for (; i + 4 <= size; i += 4) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)(data + i));
+    __m256i sum = _mm256_add_epi64(acc, x);
+    overflow = _mm256_or_si256(overflow,
+                               _YUJI_ADD_OVERFLOW(_mm256_xor_si256, _mm256_and_si256, acc, x, sum));
+    acc = sum;
+  }
+
+  if (_mm256_movemask_pd(_mm256_castsi256_pd(overflow))) {
+    return false;
+  }
+
+  int64_t lanes[7];
+  _mm256_storeu_si256((__m256i*)lanes, acc);
+  memcpy(lanes + 4, data + i, sizeof(int64_t) * (size - i));
+  memset(lanes + 4 + (size - i), 0, sizeof(int64_t) * (3 - (size - i)));
+
+  return scalar_sum_int(lanes, 7, result);
+}
+
+_YUJI_AVX2 static double avx2_sum_float(const double* data, size_t size) {
+  __m256d low = _mm256_setzero_pd();
+  __m256d high = _mm256_setzero_pd();
+  size_t i = 0;
+
+  for (; i + LANES <= size; i += LANES) {
+    low = _mm256_add_pd(low, _mm256_loadu_pd(data + i));
+    high = _mm256_add_pd(high, _mm256_loadu_pd(data + i + 4));
+  }
+
+  double lanes[LANES];
+  _mm256_storeu_pd(lanes, low);
+  _mm256_storeu_pd(lanes + 4, high);
+
+  double sum = lanes_reduce(lanes, float_add);
+
+  for (; i < size; i++) {
+    sum += data[i];
+  }
+
+  return sum;
+}
+
+// `keep` picks, per lane, whether the accumulator or the new element stays
+#define _YUJI_AVX2_FOLD_INT(NAME, KEEP_NEW, SCALAR) \
+  _YUJI_AVX2 static int64_t avx2_##NAME##_int(const int64_t* data, size_t size) { \
+    if (size < 4) { \
+      return SCALAR(data, size); \
+    } \
+    __m256i acc = _mm256_loadu_si256((const __m256i*)data); \
+    size_t i = 4; \
+    for (; i + 4 <= size; i += 4) { \
+      __m256i x = _mm256_loadu_si256((const __m256i*)(data + i)); \
+      acc = _mm256_blendv_epi8(acc, x, KEEP_NEW); \
+    } \
+    int64_t lanes[4]; \
+    _mm256_storeu_si256((__m256i*)lanes, acc); \
+    int64_t result = SCALAR(lanes, 4); \
+    if (i < size) { \
+      int64_t tail = SCALAR(data + i, size - i); \
+      lanes[0] = result; \
+      lanes[1] = tail; \
+      result = SCALAR(lanes, 2); \
+    } \
+    return result; \
+  }
+
+_YUJI_AVX2_FOLD_INT(min, _mm256_cmpgt_epi64(acc, x), scalar_min_int)
+_YUJI_AVX2_FOLD_INT(max, _mm256_cmpgt_epi64(x, acc), scalar_max_int)
+
+#define _YUJI_AVX2_FOLD_FLOAT(NAME, INTRINSIC, COMBINE) \
+  _YUJI_AVX2 static double avx2_##NAME##_float(const double* data, size_t size) { \
+    if (size < LANES) { \
+      return scalar_fold_float(data, size, COMBINE); \
+    } \
+    __m256d low = _mm256_loadu_pd(data); \
+    __m256d high = _mm256_loadu_pd(data + 4); \
+    size_t i = LANES; \
+    for (; i + LANES <= size; i += LANES) { \
+      low = INTRINSIC(low, _mm256_loadu_pd(data + i)); \
+      high = INTRINSIC(high, _mm256_loadu_pd(data + i + 4)); \
+    } \
+    double lanes[LANES]; \
+    _mm256_storeu_pd(lanes, low); \
+    _mm256_storeu_pd(lanes + 4, high); \
+    double result = lanes_reduce(lanes, COMBINE); \
+    for (; i < size; i++) { \
+      result = COMBINE(result, data[i]); \
+    } \
+    return result; \
+  }
+
+_YUJI_AVX2_FOLD_FLOAT(min, _mm256_min_pd, float_min)
+_YUJI_AVX2_FOLD_FLOAT(max, _mm256_max_pd, float_max)
+
+_YUJI_AVX2 static double avx2_dot_float(const double* left, const double* right, size_t size) {
+  __m256d low = _mm256_setzero_pd();
+  __m256d high = _mm256_setzero_pd();
+  size_t i = 0;
+
+  // multiply and add separately, a fused multiply-add would round differently
+  // from the other versions
+  for (; i + LANES <= size; i += LANES) {
+    low = _mm256_add_pd(low, _mm256_mul_pd(_mm256_loadu_pd(left + i), _mm256_loadu_pd(right + i)));
+    high = _mm256_add_pd(high, _mm256_mul_pd(_mm256_loadu_pd(left + i + 4),
+                                             _mm256_loadu_pd(right + i + 4)));
+  }
+
+  double lanes[LANES];
+  _mm256_storeu_pd(lanes, low);
+  _mm256_storeu_pd(lanes + 4, high);
+
+  double sum = lanes_reduce(lanes, float_add);
+
+  for (; i < size; i++) {
+    sum += left[i] * right[i];
+  }
+
+  return sum;
+}
+
+_YUJI_AVX2 static void avx2_scale_float(double* out, const double* data, double factor, size_t size) {
+  __m256d scale = _mm256_set1_pd(factor);
+  size_t i = 0;
+
+  for (; i + 4 <= size; i += 4) {
+    _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(data + i), scale));
+  }
+
+  scalar_scale_float(out + i, data + i, factor, size - i);
+}
+
+_YUJI_AVX2 static bool avx2_add_int(int64_t* out, const int64_t* left, const int64_t* right, size_t size) {
+  __m256i overflow = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for (; i + 4 <= size; i += 4) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)(left + i));
+    __m256i y = _mm256_loadu_si256((const __m256i*)(right + i));
+    __m256i sum = _mm256_add_epi64(x, y);
+    overflow = _mm256_or_si256(overflow,
+                               _YUJI_ADD_OVERFLOW(_mm256_xor_si256, _mm256_and_si256, x, y, sum));
+    _mm256_storeu_si256((__m256i*)(out + i), sum);
+  }
+
+  if (_mm256_movemask_pd(_mm256_castsi256_pd(overflow))) {
+    return false;
+  }
+
+  return scalar_add_int(out + i, left + i, right + i, size - i);
+}
+
+_YUJI_AVX2 static void avx2_add_float(double* out, const double* left, const double* right, size_t size) {
+  size_t i = 0;
+
+  for (; i + 4 <= size; i += 4) {
+    _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(left + i), _mm256_loadu_pd(right + i)));
+  }
+
+  scalar_add_float(out + i, left + i, right + i, size - i);
+}
+
+_YUJI_AVX2 static void avx2_fill(uint64_t* out, uint64_t bits, size_t size) {
+  __m256i value = _mm256_set1_epi64x((long long)bits);
+  size_t i = 0;
+
+  for (; i + 4 <= size; i += 4) {
+    _mm256_storeu_si256((__m256i*)(out + i), value);
+  }
+
+  scalar_fill(out + i, bits, size - i);
+}
+
+_YUJI_AVX2 static void avx2_range(int64_t* out, int64_t start, int64_t step, size_t size) {
+  uint64_t base = (uint64_t)start;
+  uint64_t stride = (uint64_t)step;
+  __m256i value = _mm256_set_epi64x((long long)(base + stride * 3), (long long)(base + stride * 2),
+                                    (long long)(base + stride), (long long)base);
+  __m256i increment = _mm256_set1_epi64x((long long)(stride * 4));
+  size_t i = 0;
+
+  for (; i + 4 <= size; i += 4) {
+    _mm256_storeu_si256((__m256i*)(out + i), value);
+    value = _mm256_add_epi64(value, increment);
+  }
+
+  scalar_range(out + i, (int64_t)(base + (uint64_t)i * stride), step, size - i);
+}
+
+_YUJI_AVX2 static void avx2_compare_int(uint64_t* out, const int64_t* left, const int64_t* right,
+                                        size_t size, YujiOperator op, uint64_t if_true,
+                                        uint64_t if_false) {
+  // every comparison is a greater-than or an equality, with the operands
+  // swapped and the result negated as needed
+  bool equality = op == YUJI_OPERATOR_EQ || op == YUJI_OPERATOR_NEQ;
+  bool swap = op == YUJI_OPERATOR_LT || op == YUJI_OPERATOR_GTE;
+  bool negate = op == YUJI_OPERATOR_LTE || op == YUJI_OPERATOR_GTE || op == YUJI_OPERATOR_NEQ;
+
+  __m256i no = _mm256_set1_epi64x((long long)(negate ? if_true : if_false));
+  __m256i flip = _mm256_set1_epi64x((long long)(if_true ^ if_false));
+  const int64_t* first = swap ? right : left;
+  const int64_t* second = swap ? left : right;
+  size_t i = 0;
+
+  for (; i + 4 <= size; i += 4) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)(first + i));
+    __m256i y = _mm256_loadu_si256((const __m256i*)(second + i));
+    __m256i mask = equality ? _mm256_cmpeq_epi64(x, y) : _mm256_cmpgt_epi64(x, y);
+    _mm256_storeu_si256((__m256i*)(out + i), _mm256_xor_si256(no, _mm256_and_si256(mask, flip)));
+  }
+
+  scalar_compare_int(out + i, left + i, right + i, size - i, op, if_true, if_false);
+}
+
+#define _YUJI_AVX2_COMPARE_LOOP(PREDICATE) \
+  for (; i + 4 <= size; i += 4) { \
+    __m256d mask = _mm256_cmp_pd(_mm256_loadu_pd(left + i), _mm256_loadu_pd(right + i), PREDICATE); \
+    __m256i result = _mm256_xor_si256(no, _mm256_and_si256(_mm256_castpd_si256(mask), flip)); \
+    _mm256_storeu_si256((__m256i*)(out + i), result); \
+  }
+
+_YUJI_AVX2 static void avx2_compare_float(uint64_t* out, const double* left, const double* right,
+                                          size_t size, YujiOperator op, uint64_t if_true,
+                                          uint64_t if_false) {
+  __m256i no = _mm256_set1_epi64x((long long)if_false);
+  __m256i flip = _mm256_set1_epi64x((long long)(if_true ^ if_false));
+  size_t i = 0;
+
+  // ordered predicates are false for NaN like the C operators, and != is true
+  switch (op) {
+    case YUJI_OPERATOR_LT:
+      _YUJI_AVX2_COMPARE_LOOP(_CMP_LT_OQ)
+      break;
+    case YUJI_OPERATOR_GT:
+      _YUJI_AVX2_COMPARE_LOOP(_CMP_GT_OQ)
+      break;
+    case YUJI_OPERATOR_LTE:
+      _YUJI_AVX2_COMPARE_LOOP(_CMP_LE_OQ)
+      break;
+    case YUJI_OPERATOR_GTE:
+      _YUJI_AVX2_COMPARE_LOOP(_CMP_GE_OQ)
+      break;
+    case YUJI_OPERATOR_EQ:
+      _YUJI_AVX2_COMPARE_LOOP(_CMP_EQ_OQ)
+      break;
+    case YUJI_OPERATOR_NEQ:
+      _YUJI_AVX2_COMPARE_LOOP(_CMP_NEQ_UQ)
+      break;
+    default:
+      break;
+  }
+
+  scalar_compare_float(out + i, left + i, right + i, size - i, op, if_true, if_false);
+}
+
+static const YujiVectorKernels AVX2_KERNELS = {
+  .name = "avx2",
+  .sum_int = avx2_sum_int,
+  .sum_float = avx2_sum_float,
+  .min_int = avx2_min_int,
+  .max_int = avx2_max_int,
+  .min_float = avx2_min_float,
+  .max_float = avx2_max_float,
+  .dot_float = avx2_dot_float,
+  .scale_float = avx2_scale_float,
+  .add_int = avx2_add_int,
+  .add_float = avx2_add_float,
+  .fill = avx2_fill,
+  .range = avx2_range,
+  .compare_int = avx2_compare_int,
+  .compare_float = avx2_compare_float,
+};
+
+#endif
+
+static const YujiVectorKernels* vector_select() {
+  const YujiVectorKernels* candidates[] = {
+#ifdef YUJI_VECTOR_X86
+    &AVX2_KERNELS,
+    &SSE2_KERNELS,
+#endif
+    &SCALAR_KERNELS,
+  };
+  size_t count = sizeof(candidates) / sizeof(candidates[0]);
+  size_t first = 0;
+
+  const char* cap = getenv("YUJI_SIMD");
+
+  if (cap) {
+    while (first < count - 1 && strcmp(candidates[first]->name, cap) != 0) {
+      first++;
+    }
+  }
+
+#ifdef YUJI_VECTOR_X86
+  __builtin_cpu_init();
+
+  if (candidates[first] == &AVX2_KERNELS && !__builtin_cpu_supports("avx2")) {
+    first++;
+  }
+#endif
+
+  return candidates[first];
+}
+
+static const YujiVectorKernels* vector_kernels() {
+  static const YujiVectorKernels* kernels = NULL;
+
+  if (!kernels) {
+    kernels = vector_select();
+  }
+
+  return kernels;
+}
+
+bool yuji_vector_sum_int(const int64_t* data, size_t size, int64_t* result) {
+  // a lane can overflow even though the sum fits, that case is settled by
+  // the scalar kernel
+  return vector_kernels()->sum_int(data, size, result) || scalar_sum_int(data, size, result);
+}
+
+double yuji_vector_sum_float(const double* data, size_t size) {
+  return vector_kernels()->sum_float(data, size);
+}
+
+int64_t yuji_vector_min_int(const int64_t* data, size_t size) {
+  return vector_kernels()->min_int(data, size);
+}
+
+int64_t yuji_vector_max_int(const int64_t* data, size_t size) {
+  return vector_kernels()->max_int(data, size);
+}
+
+double yuji_vector_min_float(const double* data, size_t size) {
+  return vector_kernels()->min_float(data, size);
+}
+
+double yuji_vector_max_float(const double* data, size_t size) {
+  return vector_kernels()->max_float(data, size);
+}
+
+double yuji_vector_dot_float(const double* left, const double* right, size_t size) {
+  return vector_kernels()->dot_float(left, right, size);
+}
+
+void yuji_vector_scale_float(double* out, const double* data, double factor, size_t size) {
+  vector_kernels()->scale_float(out, data, factor, size);
+}
+
+bool yuji_vector_add_int(int64_t* out, const int64_t* left, const int64_t* right, size_t size) {
+  return vector_kernels()->add_int(out, left, right, size);
+}
+
+void yuji_vector_add_float(double* out, const double* left, const double* right, size_t size) {
+  vector_kernels()->add_float(out, left, right, size);
+}
+
+void yuji_vector_fill(uint64_t* out, uint64_t bits, size_t size) {
+  vector_kernels()->fill(out, bits, size);
+}
+
+void yuji_vector_range(int64_t* out, int64_t start, int64_t step, size_t size) {
+  vector_kernels()->range(out, start, step, size);
+}
+
+void yuji_vector_compare_int(uint64_t* out, const int64_t* left, const int64_t* right, size_t size,
+                             YujiOperator op, uint64_t if_true, uint64_t if_false) {
+  vector_kernels()->compare_int(out, left, right, size, op, if_true, if_false);
+}
+
+void yuji_vector_compare_float(uint64_t* out, const double* left, const double* right, size_t size,
+                               YujiOperator op, uint64_t if_true, uint64_t if_false) {
+  vector_kernels()->compare_float(out, left, right, size, op, if_true, if_false);
+}
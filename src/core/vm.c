@@ -0,0 +1,889 @@
+#include "yuji/core/vm.h"
+#include "yuji/core/bytecode.h"
+#include "yuji/core/compiler.h"
+#include "yuji/core/interpreter.h"
+#include "yuji/core/memory.h"
+#include "yuji/core/module.h"
+#include "yuji/core/operator.h"
+#include "yuji/core/types/dyn_array.h"
+#include "yuji/core/types/stack.h"
+#include "yuji/core/value.h"
+#include "yuji/utils.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+YujiVM* yuji_vm_init(YujiInterpreter* interpreter) {
+  YujiVM* vm = yuji_malloc(sizeof(YujiVM));
+
+  vm->interpreter = interpreter;
+
+  vm->stack_capacity = 256;
+  vm->stack_size = 0;
+  vm->stack = yuji_malloc(sizeof(YujiValue*) * vm->stack_capacity);
+
+  vm->frame_capacity = 64;
+  vm->frame_count = 0;
+  vm->frames = yuji_malloc(sizeof(YujiVMFrame) * vm->frame_capacity);
+
+  return vm;
+}
+
+void yuji_vm_free(YujiVM* vm) {
+  yuji_check_memory(vm);
+
+  while (vm->stack_size > 0) {
+    YujiValue* value = vm->stack[--vm->stack_size];
+
+    if (value) {
+      yuji_value_free(value);
+    }
+  }
+
+  yuji_free(vm->stack);
+  yuji_free(vm->frames);
+  yuji_free(vm);
+}
+
+static inline void vm_push(YujiVM* vm, YujiValue* value) {
+  vm->stack[vm->stack_size++] = value;
+}
+
+static inline YujiValue* vm_pop(YujiVM* vm) {
+  return vm->stack[--vm->stack_size];
+}
+
+static void vm_reserve(YujiVM* vm, size_t needed) {
+  if (needed > vm->stack_capacity) {
+    while (needed > vm->stack_capacity) {
+      vm->stack_capacity *= 2;
+    }
+
+    vm->stack = yuji_realloc(vm->stack, sizeof(YujiValue*) * vm->stack_capacity);
+  }
+}
+
+// lays out `frame` for `proto` over the callee and its argc arguments, which
+// are already on the stack at `base`. the remaining local slots start out
+// unbound
+static void vm_enter(YujiVM* vm, YujiVMFrame* frame, YujiProto* proto, size_t base, size_t argc) {
+  size_t locals = proto->locals->size;
+  vm_reserve(vm, base + 1 + locals + proto->max_stack + 1);
+
+  for (size_t i = argc; i < locals; i++) {
+    vm->stack[base + 1 + i] = NULL;
+  }
+
+  vm->stack_size = base + 1 + locals;
+
+  frame->proto = proto;
+  frame->ip = proto->code;
+  frame->base = base;
+}
+
+static void vm_push_frame(YujiVM* vm, YujiProto* proto, size_t base, size_t argc,
+                          bool has_call_frame) {
+  if (vm->frame_count == vm->frame_capacity) {
+    vm->frame_capacity *= 2;
+    vm->frames = yuji_realloc(vm->frames, sizeof(YujiVMFrame) * vm->frame_capacity);
+  }
+
+  YujiVMFrame* frame = &vm->frames[vm->frame_count++];
+  frame->has_call_frame = has_call_frame;
+  vm_enter(vm, frame, proto, base, argc);
+}
+
+// locals of enclosing functions live in the nearest frame running that
+// function, which covers callbacks passed down the call stack
+static YujiValue** vm_outer_slot(YujiVM* vm, YujiProtoOuter* outer) {
+  for (size_t i = vm->frame_count; i-- > 0;) {
+    YujiVMFrame* frame = &vm->frames[i];
+
+    if (frame->proto->id == outer->proto_id) {
+      return &vm->stack[frame->base + 1 + outer->slot];
+    }
+  }
+
+  yuji_panic("name %s not found", outer->name);
+}
+
+static inline void vm_store(YujiValue** slot, YujiValue* value) {
+  YujiValue* old = *slot;
+  *slot = value;
+
+  if (old) {
+    yuji_value_free(old);
+  }
+}
+
+// true if `instr` stores to the variable that currently holds `value`
+static inline bool vm_overwrites(YujiVM* vm, YujiVMFrame* frame, YujiInstr instr,
+                                 YujiValue* value) {
+  switch (YUJI_INSTR_OP(instr)) {
+    case OP_SET_LOCAL:
+      return vm->stack[frame->base + 1 + YUJI_INSTR_ARG(instr)] == value;
+
+    case OP_SET_OUTER:
+      return *vm_outer_slot(vm, frame->proto->outers->data[YUJI_INSTR_ARG(instr)]) == value;
+
+    case OP_SET_GLOBAL:
+      return frame->proto->globals->values[YUJI_INSTR_ARG(instr)] == value;
+
+    default:
+      return false;
+  }
+}
+
+static inline void vm_check_arity(YujiProto* proto, size_t argc, const char* name) {
+  if (proto->params->size != argc) {
+    yuji_panic("function %s expects %zu args, got %zu", name, proto->params->size, argc);
+  }
+}
+
+// the callee and its argc arguments are on top of the stack. native functions
+// run to completion here, bytecode functions get a new frame that the
+// dispatch loop picks up
+static void vm_call(YujiVM* vm, size_t argc, const char* name) {
+  YujiInterpreter* interpreter = vm->interpreter;
+  size_t base = vm->stack_size - argc - 1;
+  YujiValue* fn = vm->stack[base];
+
+  if (yuji_value_type(fn) == VT_CFUNCTION) {
+    if (fn->value.cfunction->argc != YUJI_FN_INF_ARGUMENT && fn->value.cfunction->argc != argc) {
+      yuji_panic("function '%s' expects %ld, got %ld", name, fn->value.cfunction->argc, argc);
+    }
+
+    YujiDynArray* args = yuji_dyn_array_init();
+
+    for (size_t i = 0; i < argc; i++) {
+      yuji_dyn_array_push(args, vm->stack[base + 1 + i]);
+    }
+
+    vm->stack_size = base + 1;
+
+    YujiCallFrame* frame = yuji_call_frame_init(interpreter->current_scope, name, args);
+    yuji_stack_push(interpreter->call_stack, frame);
+
+    YujiValue* result = fn->value.cfunction->func(interpreter->current_scope, args);
+
+    yuji_call_frame_free(yuji_stack_pop(interpreter->call_stack));
+
+    yuji_value_free(vm_pop(vm));
+    vm_push(vm, result);
+    return;
+  }
+
+  if (yuji_value_type(fn) != VT_FUNCTION || !fn->value.function.proto) {
+    yuji_panic("'%s' is not a function (got '%s')", name, yuji_value_to_string(fn));
+  }
+
+  YujiProto* proto = fn->value.function.proto;
+  vm_check_arity(proto, argc, name);
+
+  if (interpreter->call_stack->data->size > interpreter->max_stack_size) {
+    yuji_panic("stack overflow");
+  }
+
+  YujiCallFrame* frame = yuji_call_frame_init(interpreter->current_scope, name, NULL);
+  yuji_stack_push(interpreter->call_stack, frame);
+
+  vm_push_frame(vm, proto, base, argc, true);
+}
+
+// a call in tail position: a bytecode callee takes over the current frame,
+// the caller's slots are released and the callee and its arguments are moved
+// down to its base. returns false if the callee is not a bytecode function,
+// which is then called normally
+static bool vm_tail_call(YujiVM* vm, YujiVMFrame* frame, size_t argc, const char* name) {
+  size_t callee = vm->stack_size - argc - 1;
+  YujiValue* fn = vm->stack[callee];
+
+  if (yuji_value_type(fn) != VT_FUNCTION || !fn->value.function.proto) {
+    return false;
+  }
+
+  YujiProto* proto = fn->value.function.proto;
+  vm_check_arity(proto, argc, name);
+
+  for (size_t i = frame->base; i < callee; i++) {
+    if (vm->stack[i]) {
+      yuji_value_free(vm->stack[i]);
+    }
+  }
+
+  memmove(&vm->stack[frame->base], &vm->stack[callee], sizeof(YujiValue*) * (argc + 1));
+
+  // the traceback shows the function that is running now
+  if (frame->has_call_frame) {
+    YujiInterpreter* interpreter = vm->interpreter;
+    yuji_call_frame_free(yuji_stack_pop(interpreter->call_stack));
+    yuji_stack_push(interpreter->call_stack,
+                    yuji_call_frame_init(interpreter->current_scope, name, NULL));
+  }
+
+  vm_enter(vm, frame, proto, frame->base, argc);
+  return true;
+}
+
+// the variable or constant a packed slot names. variables that are not bound
+// yet panic
+static inline YujiValue** vm_slot(YujiVM* vm, YujiVMFrame* frame, uint32_t slot) {
+  uint32_t index = YUJI_SLOT_INDEX(slot);
+  YujiValue** value;
+
+  switch (YUJI_SLOT_KIND(slot)) {
+    case YUJI_SLOT_LOCAL:
+      value = &vm->stack[frame->base + 1 + index];
+
+      if (!*value) {
+        yuji_panic("name %s not found", (char*)frame->proto->locals->data[index]);
+      }
+
+      return value;
+
+    case YUJI_SLOT_GLOBAL:
+      value = &frame->proto->globals->values[index];
+
+      if (!*value) {
+        yuji_panic("name %s not found", frame->proto->globals->names[index]);
+      }
+
+      return value;
+
+    default:
+      return (YujiValue**)&frame->proto->constants->data[index];
+  }
+}
+
+// checks that `object[index]` is a valid array access
+static inline size_t vm_index(YujiValue* object, YujiValue* index) {
+  if (yuji_value_type(object) != VT_ARRAY) {
+    yuji_panic("Cannot index non-array type");
+  }
+
+  if (yuji_value_type(index) != VT_INT) {
+    yuji_panic("Array index must be an integer");
+  }
+
+  int64_t i = yuji_value_as_int(index);
+
+  if (i < 0 || (size_t)i >= object->value.array->size) {
+    yuji_panic("Array index out of bounds: %lld", (long long)i);
+  }
+
+  return (size_t)i;
+}
+
+// true if both values are tagged ints, which need no reference counting
+static inline bool vm_small_ints(YujiValue* left, YujiValue* right) {
+  return ((uintptr_t)left & (uintptr_t)right & 1) != 0;
+}
+
+// false when the operator has no int fast path or the result overflows
+static inline bool vm_int_arith(YujiOperator op, int64_t left, int64_t right, int64_t* result) {
+  switch (op) {
+    case YUJI_OPERATOR_ADD:
+      return !__builtin_add_overflow(left, right, result);
+
+    case YUJI_OPERATOR_SUB:
+      return !__builtin_sub_overflow(left, right, result);
+
+    case YUJI_OPERATOR_MUL:
+      return !__builtin_mul_overflow(left, right, result);
+
+    default:
+      return false;
+  }
+}
+
+static inline bool vm_int_compare(YujiOperator op, int64_t left, int64_t right) {
+  switch (op) {
+    case YUJI_OPERATOR_LT:
+      return left < right;
+
+    case YUJI_OPERATOR_GT:
+      return left > right;
+
+    case YUJI_OPERATOR_LTE:
+      return left <= right;
+
+    case YUJI_OPERATOR_GTE:
+      return left >= right;
+
+    case YUJI_OPERATOR_EQ:
+      return left == right;
+
+    default:
+      return left != right;
+  }
+}
+
+// dispatch of the loop below. with YUJI_COMPUTED_GOTO every handler fetches
+// the next instruction and jumps straight to its handler through a table of
+// label addresses, which gives each handler its own indirect branch to
+// predict. otherwise all handlers return to a single switch
+#if !defined(YUJI_COMPUTED_GOTO)
+#if defined(__GNUC__)
+#define YUJI_COMPUTED_GOTO 1
+#else
+#define YUJI_COMPUTED_GOTO 0
+#endif
+#endif
+
+#define VM_FETCH()                                                                                 \
+  do {                                                                                             \
+    instr = *ip++;                                                                                 \
+    op = YUJI_INSTR_OP(instr);                                                                     \
+    YUJI_LOG("executing opcode: %s (%u)", yuji_opcode_to_string(op), YUJI_INSTR_ARG(instr));       \
+  } while (0)
+
+#if YUJI_COMPUTED_GOTO
+#define VM_DISPATCH_LOOP
+#define VM_SWITCH goto* labels[op];
+#define VM_CASE(OP) VM_LABEL_##OP
+#define VM_DEFAULT VM_LABEL_UNKNOWN
+#define VM_NEXT()                                                                                  \
+  do {                                                                                             \
+    VM_FETCH();                                                                                    \
+    goto* labels[op];                                                                              \
+  } while (0)
+#else
+#define VM_DISPATCH_LOOP while (true)
+#define VM_SWITCH switch (op)
+#define VM_CASE(OP) case OP
+#define VM_DEFAULT default
+#define VM_NEXT() continue
+#endif
+
+static YujiValue* vm_execute(YujiVM* vm, size_t entry) {
+  YujiInterpreter* interpreter = vm->interpreter;
+  YujiVMFrame* frame = &vm->frames[vm->frame_count - 1];
+  YujiInstr* ip = frame->ip;
+  YujiInstr instr;
+  YujiOpCode op;
+
+#if YUJI_COMPUTED_GOTO
+#define _YUJI_VM_LABEL(op) [op] = &&VM_LABEL_##op
+
+  // every byte maps to a handler, bytes that are no opcode to the panic
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Woverride-init"
+  static void* const labels[256] = {
+    [0 ... 255] = &&VM_LABEL_UNKNOWN,
+    _YUJI_VM_LABEL(OP_CONST),
+    _YUJI_VM_LABEL(OP_NULL),
+    _YUJI_VM_LABEL(OP_TRUE),
+    _YUJI_VM_LABEL(OP_FALSE),
+    _YUJI_VM_LABEL(OP_POP),
+    _YUJI_VM_LABEL(OP_GET_LOCAL),
+    _YUJI_VM_LABEL(OP_SET_LOCAL),
+    _YUJI_VM_LABEL(OP_DEFINE_LOCAL),
+    _YUJI_VM_LABEL(OP_GET_OUTER),
+    _YUJI_VM_LABEL(OP_SET_OUTER),
+    _YUJI_VM_LABEL(OP_GET_GLOBAL),
+    _YUJI_VM_LABEL(OP_SET_GLOBAL),
+    _YUJI_VM_LABEL(OP_DEFINE_GLOBAL),
+    _YUJI_VM_LABEL(OP_DEFINE_FUNCTION),
+    _YUJI_VM_LABEL(OP_JUMP),
+    _YUJI_VM_LABEL(OP_JUMP_IF_FALSE),
+    _YUJI_VM_LABEL(OP_ADD),
+    _YUJI_VM_LABEL(OP_SUB),
+    _YUJI_VM_LABEL(OP_MUL),
+    _YUJI_VM_LABEL(OP_DIV),
+    _YUJI_VM_LABEL(OP_MOD),
+    _YUJI_VM_LABEL(OP_LT),
+    _YUJI_VM_LABEL(OP_GT),
+    _YUJI_VM_LABEL(OP_LTE),
+    _YUJI_VM_LABEL(OP_GTE),
+    _YUJI_VM_LABEL(OP_EQ),
+    _YUJI_VM_LABEL(OP_NEQ),
+    _YUJI_VM_LABEL(OP_FUNCTION),
+    _YUJI_VM_LABEL(OP_CALL),
+    _YUJI_VM_LABEL(OP_TAIL_CALL),
+    _YUJI_VM_LABEL(OP_RETURN),
+    _YUJI_VM_LABEL(OP_ARRAY),
+    _YUJI_VM_LABEL(OP_INDEX_GET),
+    _YUJI_VM_LABEL(OP_INDEX_SET),
+    _YUJI_VM_LABEL(OP_USE),
+    _YUJI_VM_LABEL(OP_UPDATE),
+    _YUJI_VM_LABEL(OP_COMPARE_JUMP),
+    _YUJI_VM_LABEL(OP_INDEX_SLOT),
+    _YUJI_VM_LABEL(OP_ADD_INT),
+    _YUJI_VM_LABEL(OP_SUB_INT),
+    _YUJI_VM_LABEL(OP_MUL_INT),
+    _YUJI_VM_LABEL(OP_DIV_INT),
+    _YUJI_VM_LABEL(OP_MOD_INT),
+    _YUJI_VM_LABEL(OP_LT_INT),
+    _YUJI_VM_LABEL(OP_GT_INT),
+    _YUJI_VM_LABEL(OP_LTE_INT),
+    _YUJI_VM_LABEL(OP_GTE_INT),
+    _YUJI_VM_LABEL(OP_EQ_INT),
+    _YUJI_VM_LABEL(OP_NEQ_INT),
+  };
+#pragma GCC diagnostic pop
+
+#undef _YUJI_VM_LABEL
+#endif
+
+  VM_DISPATCH_LOOP {
+    VM_FETCH();
+
+    VM_SWITCH {
+      VM_CASE(OP_CONST): {
+        YujiValue* value = frame->proto->constants->data[YUJI_INSTR_ARG(instr)];
+        yuji_value_ref(value);
+        vm_push(vm, value);
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_NULL):
+        vm_push(vm, yuji_value_null_init());
+        VM_NEXT();
+
+      VM_CASE(OP_TRUE):
+        vm_push(vm, yuji_value_bool_init(true));
+        VM_NEXT();
+
+      VM_CASE(OP_FALSE):
+        vm_push(vm, yuji_value_bool_init(false));
+        VM_NEXT();
+
+      VM_CASE(OP_POP):
+        yuji_value_free(vm_pop(vm));
+        VM_NEXT();
+
+      VM_CASE(OP_GET_LOCAL): {
+        YujiValue* value = vm->stack[frame->base + 1 + YUJI_INSTR_ARG(instr)];
+
+        if (!value) {
+          yuji_panic("name %s not found", (char*)frame->proto->locals->data[YUJI_INSTR_ARG(instr)]);
+        }
+
+        yuji_value_ref(value);
+        vm_push(vm, value);
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_SET_LOCAL):
+      VM_CASE(OP_DEFINE_LOCAL): {
+        YujiValue* value = vm_pop(vm);
+        vm_store(&vm->stack[frame->base + 1 + YUJI_INSTR_ARG(instr)], value);
+        vm_push(vm, yuji_value_null_init());
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_GET_OUTER): {
+        YujiProtoOuter* outer = frame->proto->outers->data[YUJI_INSTR_ARG(instr)];
+        YujiValue* value = *vm_outer_slot(vm, outer);
+
+        if (!value) {
+          yuji_panic("name %s not found", outer->name);
+        }
+
+        yuji_value_ref(value);
+        vm_push(vm, value);
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_SET_OUTER): {
+        YujiProtoOuter* outer = frame->proto->outers->data[YUJI_INSTR_ARG(instr)];
+        YujiValue** slot = vm_outer_slot(vm, outer);
+
+        if (!*slot) {
+          yuji_panic("name %s not found", outer->name);
+        }
+
+        vm_store(slot, vm_pop(vm));
+        vm_push(vm, yuji_value_null_init());
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_GET_GLOBAL): {
+        YujiScope* globals = frame->proto->globals;
+        YujiValue* value = globals->values[YUJI_INSTR_ARG(instr)];
+
+        if (!value) {
+          yuji_panic("name %s not found", globals->names[YUJI_INSTR_ARG(instr)]);
+        }
+
+        yuji_value_ref(value);
+        vm_push(vm, value);
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_SET_GLOBAL): {
+        YujiScope* globals = frame->proto->globals;
+        YujiValue** slot = &globals->values[YUJI_INSTR_ARG(instr)];
+
+        if (!*slot) {
+          yuji_panic("name %s not found", globals->names[YUJI_INSTR_ARG(instr)]);
+        }
+
+        vm_store(slot, vm_pop(vm));
+        globals->imported[YUJI_INSTR_ARG(instr)] = false;
+        vm_push(vm, yuji_value_null_init());
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_DEFINE_GLOBAL):
+      VM_CASE(OP_DEFINE_FUNCTION): {
+        YujiScope* globals = frame->proto->globals;
+        size_t index = YUJI_INSTR_ARG(instr);
+        YujiValue** slot = &globals->values[index];
+
+        // names from `use` may be redefined by the module itself
+        if (*slot && !globals->imported[index]) {
+          yuji_panic("%s %s already exists", op == OP_DEFINE_GLOBAL ? "variable" : "function",
+                     globals->names[index]);
+        }
+
+        if (*slot) {
+          yuji_value_free(*slot);
+          globals->imported[index] = false;
+        }
+
+        *slot = vm_pop(vm);
+        vm_push(vm, yuji_value_null_init());
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_JUMP):
+        ip += YUJI_INSTR_SARG(instr);
+        VM_NEXT();
+
+      VM_CASE(OP_JUMP_IF_FALSE): {
+        YujiValue* condition = vm_pop(vm);
+        bool result = yuji_value_to_bool(condition);
+        yuji_value_free(condition);
+
+        if (!result) {
+          ip += YUJI_INSTR_SARG(instr);
+        }
+
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_ADD):
+      VM_CASE(OP_SUB):
+      VM_CASE(OP_MUL):
+      VM_CASE(OP_DIV):
+      VM_CASE(OP_MOD):
+      VM_CASE(OP_LT):
+      VM_CASE(OP_GT):
+      VM_CASE(OP_LTE):
+      VM_CASE(OP_GTE):
+      VM_CASE(OP_EQ):
+      VM_CASE(OP_NEQ):
+      vm_binary: {
+        YujiValue* right = vm_pop(vm);
+        YujiValue* left = vm_pop(vm);
+
+        // quickening: a site that sees two ints switches to the int version
+        if (vm_small_ints(left, right)) {
+          ip[-1] = YUJI_INSTR(YUJI_OPCODE_TO_INT(op), 0);
+        }
+
+        YujiValue* result = op == OP_ADD && vm_overwrites(vm, frame, *ip, left)
+                            ? yuji_operator_eval_update(YUJI_OPCODE_TO_OPERATOR(op), left, right)
+                            : yuji_operator_eval(YUJI_OPCODE_TO_OPERATOR(op), left, right);
+
+        yuji_value_free(left);
+        yuji_value_free(right);
+        vm_push(vm, result);
+        VM_NEXT();
+      }
+
+#define _YUJI_VM_DEQUICKEN()                                                                       \
+  do {                                                                                             \
+    op = YUJI_OPCODE_FROM_INT(op);                                                                 \
+    ip[-1] = YUJI_INSTR(op, 0);                                                                    \
+    goto vm_binary;                                                                                \
+  } while (0)
+
+#define _YUJI_VM_INT_ARITH(OP, BUILTIN)                                                            \
+  VM_CASE(OP): {                                                                                   \
+    YujiValue* right = vm->stack[vm->stack_size - 1];                                              \
+    YujiValue* left = vm->stack[vm->stack_size - 2];                                               \
+    int64_t result;                                                                                \
+                                                                                                   \
+    if (!vm_small_ints(left, right) ||                                                             \
+        BUILTIN(yuji_value_as_int(left), yuji_value_as_int(right), &result)) {                     \
+      _YUJI_VM_DEQUICKEN();                                                                        \
+    }                                                                                              \
+                                                                                                   \
+    vm->stack[--vm->stack_size - 1] = yuji_value_int_init(result);                                 \
+    VM_NEXT();                                                                                     \
+  }
+
+#define _YUJI_VM_INT_DIVIDE(OP, EXPR)                                                              \
+  VM_CASE(OP): {                                                                                   \
+    YujiValue* right = vm->stack[vm->stack_size - 1];                                              \
+    YujiValue* left = vm->stack[vm->stack_size - 2];                                               \
+                                                                                                   \
+    if (!vm_small_ints(left, right) || yuji_value_as_int(right) == 0) {                            \
+      _YUJI_VM_DEQUICKEN();                                                                        \
+    }                                                                                              \
+                                                                                                   \
+    int64_t result = yuji_value_as_int(left) EXPR yuji_value_as_int(right);                        \
+    vm->stack[--vm->stack_size - 1] = yuji_value_int_init(result);                                 \
+    VM_NEXT();                                                                                     \
+  }
+
+#define _YUJI_VM_INT_COMPARE(OP, EXPR)                                                             \
+  VM_CASE(OP): {                                                                                   \
+    YujiValue* right = vm->stack[vm->stack_size - 1];                                              \
+    YujiValue* left = vm->stack[vm->stack_size - 2];                                               \
+                                                                                                   \
+    if (!vm_small_ints(left, right)) {                                                             \
+      _YUJI_VM_DEQUICKEN();                                                                        \
+    }                                                                                              \
+                                                                                                   \
+    bool result = yuji_value_as_int(left) EXPR yuji_value_as_int(right);                           \
+    vm->stack[--vm->stack_size - 1] = yuji_value_bool_init(result);                                \
+    VM_NEXT();                                                                                     \
+  }
+
+      // tagged ints hold no reference, so the operands are overwritten
+      // without being freed. anything the int version cannot handle, such as
+      // an overflow or a division by zero, is left to the generic version
+      _YUJI_VM_INT_ARITH(OP_ADD_INT, __builtin_add_overflow)
+      _YUJI_VM_INT_ARITH(OP_SUB_INT, __builtin_sub_overflow)
+      _YUJI_VM_INT_ARITH(OP_MUL_INT, __builtin_mul_overflow)
+      _YUJI_VM_INT_DIVIDE(OP_DIV_INT, /)
+      _YUJI_VM_INT_DIVIDE(OP_MOD_INT, %)
+      _YUJI_VM_INT_COMPARE(OP_LT_INT, <)
+      _YUJI_VM_INT_COMPARE(OP_GT_INT, >)
+      _YUJI_VM_INT_COMPARE(OP_LTE_INT, <=)
+      _YUJI_VM_INT_COMPARE(OP_GTE_INT, >=)
+      _YUJI_VM_INT_COMPARE(OP_EQ_INT, ==)
+      _YUJI_VM_INT_COMPARE(OP_NEQ_INT, !=)
+
+#undef _YUJI_VM_INT_COMPARE
+#undef _YUJI_VM_INT_DIVIDE
+#undef _YUJI_VM_INT_ARITH
+#undef _YUJI_VM_DEQUICKEN
+
+      VM_CASE(OP_UPDATE): {
+        uint32_t target = YUJI_INSTR_ARG(instr);
+        YujiInstr update = *ip++;
+        YujiOperator operator = (YujiOperator)YUJI_INSTR_OP(update);
+        YujiValue** slot = vm_slot(vm, frame, target);
+        YujiValue* left = *slot;
+        YujiValue* right = frame->proto->constants->data[YUJI_INSTR_ARG(update)];
+        int64_t result;
+
+        if (vm_small_ints(left, right) &&
+            vm_int_arith(operator, yuji_value_as_int(left), yuji_value_as_int(right), &result)) {
+          *slot = yuji_value_int_init(result);
+        } else {
+          yuji_value_ref(left);
+          YujiValue* value = yuji_operator_eval_update(operator, left, right);
+          yuji_value_free(left);
+          vm_store(slot, value);
+        }
+
+        if (YUJI_SLOT_KIND(target) == YUJI_SLOT_GLOBAL) {
+          frame->proto->globals->imported[YUJI_SLOT_INDEX(target)] = false;
+        }
+
+        vm_push(vm, yuji_value_null_init());
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_COMPARE_JUMP): {
+        YujiInstr compare = ip[0];
+        YujiOperator operator = (YujiOperator)YUJI_INSTR_OP(compare);
+        YujiValue* left = *vm_slot(vm, frame, YUJI_INSTR_ARG(compare));
+        YujiValue* right = *vm_slot(vm, frame, ip[1]);
+        bool result;
+
+        if (vm_small_ints(left, right)) {
+          result = vm_int_compare(operator, yuji_value_as_int(left), yuji_value_as_int(right));
+        } else {
+          YujiValue* value = yuji_operator_eval(operator, left, right);
+          result = yuji_value_to_bool(value);
+          yuji_value_free(value);
+        }
+
+        ip += result ? 2 : YUJI_INSTR_SARG(instr);
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_INDEX_SLOT): {
+        YujiValue* array = *vm_slot(vm, frame, YUJI_INSTR_ARG(instr));
+        YujiValue* index = *vm_slot(vm, frame, *ip++);
+
+        size_t i = vm_index(array, index);
+
+        vm_push(vm, yuji_array_get(array->value.array, i));
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_FUNCTION): {
+        YujiProto* proto = frame->proto->protos->data[YUJI_INSTR_ARG(instr)];
+        vm_push(vm, yuji_value_proto_init(proto));
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_CALL): {
+        const char* name = frame->proto->names->data[*ip++];
+        frame->ip = ip;
+
+        vm_call(vm, YUJI_INSTR_ARG(instr), name);
+
+        frame = &vm->frames[vm->frame_count - 1];
+        ip = frame->ip;
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_TAIL_CALL): {
+        const char* name = frame->proto->names->data[*ip++];
+
+        if (vm_tail_call(vm, frame, YUJI_INSTR_ARG(instr), name)) {
+          ip = frame->ip;
+          VM_NEXT();
+        }
+
+        frame->ip = ip;
+        vm_call(vm, YUJI_INSTR_ARG(instr), name);
+
+        frame = &vm->frames[vm->frame_count - 1];
+        ip = frame->ip;
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_RETURN): {
+        YujiValue* result = vm_pop(vm);
+
+        while (vm->stack_size > frame->base) {
+          YujiValue* value = vm_pop(vm);
+
+          if (value) {
+            yuji_value_free(value);
+          }
+        }
+
+        if (frame->has_call_frame) {
+          yuji_call_frame_free(yuji_stack_pop(interpreter->call_stack));
+        }
+
+        vm->frame_count--;
+
+        if (vm->frame_count == entry) {
+          return result;
+        }
+
+        vm_push(vm, result);
+        frame = &vm->frames[vm->frame_count - 1];
+        ip = frame->ip;
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_ARRAY): {
+        size_t count = YUJI_INSTR_ARG(instr);
+        YujiArray* elements = yuji_array_init(count);
+
+        for (size_t i = vm->stack_size - count; i < vm->stack_size; i++) {
+          yuji_array_push(elements, vm->stack[i]);
+        }
+
+        vm->stack_size -= count;
+        vm_push(vm, yuji_value_array_init(elements));
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_INDEX_GET): {
+        YujiValue* index_val = vm_pop(vm);
+        YujiValue* obj_val = vm_pop(vm);
+        size_t index = vm_index(obj_val, index_val);
+        yuji_value_free(index_val);
+
+        YujiValue* element = yuji_array_get(obj_val->value.array, index);
+        yuji_value_free(obj_val);
+        vm_push(vm, element);
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_INDEX_SET): {
+        YujiValue* new_value = vm_pop(vm);
+        YujiValue* index_val = vm_pop(vm);
+        YujiValue* obj_val = vm_pop(vm);
+        size_t index = vm_index(obj_val, index_val);
+        yuji_value_free(index_val);
+
+        yuji_array_set(obj_val->value.array, index, new_value);
+        yuji_value_free(obj_val);
+        vm_push(vm, yuji_value_null_init());
+        VM_NEXT();
+      }
+
+      VM_CASE(OP_USE): {
+        frame->ip = ip;
+
+        YujiModule* module =
+          yuji_interpreter_find_module(interpreter, frame->proto->names->data[YUJI_INSTR_ARG(instr)]);
+        yuji_scope_merge(frame->proto->globals, module->scope);
+
+        frame = &vm->frames[vm->frame_count - 1];
+        ip = frame->ip;
+        vm_push(vm, yuji_value_null_init());
+        VM_NEXT();
+      }
+
+      VM_DEFAULT:
+        yuji_panic("Unknown opcode: %d", op);
+    }
+  }
+}
+
+YujiValue* yuji_vm_run(YujiVM* vm, YujiProto* proto) {
+  yuji_check_memory(vm);
+  yuji_check_memory(proto);
+
+  size_t entry = vm->frame_count;
+  size_t base = vm->stack_size;
+
+  // modules have no callee, keep its slot empty
+  vm_push_frame(vm, proto, base, 0, false);
+  vm->stack[base] = NULL;
+
+  return vm_execute(vm, entry);
+}
+
+YujiValue* yuji_vm_call(YujiVM* vm, YujiValue* fn, YujiValue** args, size_t argc, const char* name) {
+  yuji_check_memory(vm);
+
+  size_t entry = vm->frame_count;
+  vm_reserve(vm, vm->stack_size + 1 + argc);
+
+  vm_push(vm, yuji_value_ref(fn));
+
+  for (size_t i = 0; i < argc; i++) {
+    vm_push(vm, yuji_value_ref(args[i]));
+  }
+
+  vm_call(vm, argc, name);
+
+  // native functions have already left their result on the stack
+  if (vm->frame_count == entry) {
+    return vm_pop(vm);
+  }
+
+  return vm_execute(vm, entry);
+}
+
+YujiValue* yuji_vm_eval_module(YujiVM* vm, YujiASTModule* module) {
+  yuji_check_memory(vm);
+  yuji_check_memory(module);
+
+  YUJI_LOG("ENTER MODULE: %s | EXPRS SIZE: %ld", module->name, module->exprs->size)
+
+  YujiInterpreter* interpreter = vm->interpreter;
+  YujiProto* proto = yuji_compiler_compile_module(interpreter, interpreter->current_scope, module);
+  YujiValue* result = yuji_vm_run(vm, proto);
+  yuji_proto_free(proto);
+
+  YUJI_LOG("LEAVE MODULE: %s", module->name)
+
+  return result;
+}
@@ -1,9 +1,160 @@
+#include "yuji/core/array.h"
 #include "yuji/core/interpreter.h"
 #include "yuji/core/memory.h"
 #include "yuji/core/module.h"
+#include "yuji/core/operator.h"
 #include "yuji/core/types/dyn_array.h"
 #include "yuji/core/value.h"
+#include "yuji/core/vector.h"
 #include "yuji/utils.h"
+#include <string.h>
+
+// the elements of an array argument as unboxed numbers. generic arrays that
+// only hold numbers are copied into `buffer`
+typedef struct {
+  YujiArrayKind kind; // YUJI_ARRAY_INT or YUJI_ARRAY_FLOAT
+  size_t size;
+  const int64_t* ints;
+  const double* floats;
+  void* buffer;
+} ArrayNumbers;
+
+static bool is_number(YujiValue* value) {
+  return yuji_value_type(value) == VT_INT || yuji_value_type(value) == VT_FLOAT;
+}
+
+static double number_value(YujiValue* value) {
+  return yuji_value_type(value) == VT_INT ? (double)yuji_value_as_int(value)
+                                          : yuji_value_as_float(value);
+}
+
+static ArrayNumbers array_numbers(YujiValue* value, const char* function_name) {
+  if (yuji_value_type(value) != VT_ARRAY) {
+    yuji_panic("%s function expects an array", function_name);
+  }
+
+  YujiArray* array = value->value.array;
+  ArrayNumbers numbers = {YUJI_ARRAY_INT, array->size, array->data.ints, NULL, NULL};
+
+  switch (array->kind) {
+    case YUJI_ARRAY_EMPTY:
+    case YUJI_ARRAY_INT:
+      return numbers;
+
+    case YUJI_ARRAY_FLOAT:
+      numbers.kind = YUJI_ARRAY_FLOAT;
+      numbers.ints = NULL;
+      numbers.floats = array->data.floats;
+      return numbers;
+
+    case YUJI_ARRAY_GENERIC:
+      break;
+  }
+
+  bool ints = true;
+
+  for (size_t i = 0; i < array->size; i++) {
+    YujiValue* element = array->data.values[i];
+
+    if (!is_number(element)) {
+      yuji_panic("%s function expects an array of numbers", function_name);
+    }
+
+    ints = ints && yuji_value_type(element) == VT_INT;
+  }
+
+  numbers.buffer = yuji_malloc(sizeof(int64_t) * (array->size + 1));
+
+  if (ints) {
+    int64_t* buffer = numbers.buffer;
+
+    for (size_t i = 0; i < array->size; i++) {
+      buffer[i] = yuji_value_as_int(array->data.values[i]);
+    }
+
+    numbers.ints = buffer;
+    return numbers;
+  }
+
+  double* buffer = numbers.buffer;
+
+  for (size_t i = 0; i < array->size; i++) {
+    buffer[i] = number_value(array->data.values[i]);
+  }
+
+  numbers.kind = YUJI_ARRAY_FLOAT;
+  numbers.ints = NULL;
+  numbers.floats = buffer;
+  return numbers;
+}
+
+// converts int elements to floats for operations on mixed arguments
+static const double* numbers_floats(ArrayNumbers* numbers) {
+  if (numbers->kind == YUJI_ARRAY_FLOAT) {
+    return numbers->floats;
+  }
+
+  double* buffer = yuji_malloc(sizeof(double) * (numbers->size + 1));
+
+  for (size_t i = 0; i < numbers->size; i++) {
+    buffer[i] = (double)numbers->ints[i];
+  }
+
+  if (numbers->buffer) {
+    yuji_free(numbers->buffer);
+  }
+
+  numbers->kind = YUJI_ARRAY_FLOAT;
+  numbers->ints = NULL;
+  numbers->floats = buffer;
+  numbers->buffer = buffer;
+  return buffer;
+}
+
+static void numbers_free(ArrayNumbers* numbers) {
+  if (numbers->buffer) {
+    yuji_free(numbers->buffer);
+  }
+}
+
+// the second operand of an element-wise function, an array of the same size
+// or a number that is repeated
+static ArrayNumbers operand_numbers(YujiValue* value, size_t size, const char* function_name) {
+  if (yuji_value_type(value) == VT_ARRAY) {
+    ArrayNumbers numbers = array_numbers(value, function_name);
+
+    if (numbers.size != size) {
+      numbers_free(&numbers);
+      yuji_panic("%s function expects arrays of the same length, got %zu and %zu", function_name,
+                 size, numbers.size);
+    }
+
+    return numbers;
+  }
+
+  if (!is_number(value)) {
+    yuji_panic("%s function expects an array or a number", function_name);
+  }
+
+  ArrayNumbers numbers = {YUJI_ARRAY_INT, size, NULL, NULL, NULL};
+  uint64_t* buffer = yuji_malloc(sizeof(uint64_t) * (size + 1));
+  numbers.buffer = buffer;
+
+  if (yuji_value_type(value) == VT_INT) {
+    yuji_vector_fill(buffer, (uint64_t)yuji_value_as_int(value), size);
+    numbers.ints = (int64_t*)buffer;
+    return numbers;
+  }
+
+  double number = yuji_value_as_float(value);
+  uint64_t bits;
+  memcpy(&bits, &number, sizeof(bits));
+  yuji_vector_fill(buffer, bits, size);
+
+  numbers.kind = YUJI_ARRAY_FLOAT;
+  numbers.floats = (double*)buffer;
+  return numbers;
+}
 
 static YujiValue* array_len(YujiScope* scope, YujiDynArray* args) {
   YUJI_UNUSED(scope);
@@ -14,7 +165,7 @@ static YujiValue* array_len(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* array = yuji_dyn_array_get(args, 0);
 
-  if (array->type != VT_ARRAY) {
+  if (yuji_value_type(array) != VT_ARRAY) {
     yuji_panic("len function expects an array");
   }
 
@@ -31,12 +182,11 @@ static YujiValue* array_push(YujiScope* scope, YujiDynArray* args) {
   YujiValue* array = yuji_dyn_array_get(args, 0);
   YujiValue* value = yuji_dyn_array_get(args, 1);
 
-  if (array->type != VT_ARRAY) {
+  if (yuji_value_type(array) != VT_ARRAY) {
     yuji_panic("push function expects an array");
   }
 
-  value->refcount++;
-  yuji_dyn_array_push(array->value.array, value);
+  yuji_array_push(array->value.array, yuji_value_ref(value));
 
   return yuji_value_null_init();
 }
@@ -50,7 +200,7 @@ static YujiValue* array_pop(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* array = yuji_dyn_array_get(args, 0);
 
-  if (array->type != VT_ARRAY) {
+  if (yuji_value_type(array) != VT_ARRAY) {
     yuji_panic("pop function expects an array");
   }
 
@@ -58,13 +208,728 @@ static YujiValue* array_pop(YujiScope* scope, YujiDynArray* args) {
     yuji_panic("pop function called on empty array");
   }
 
-  YujiValue* value = yuji_dyn_array_pop(array->value.array);
+  return yuji_array_pop(array->value.array);
+}
+
+static YujiValue* array_sum(YujiScope* scope, YujiDynArray* args) {
+  YUJI_UNUSED(scope);
+
+  if (args->size != 1) {
+    yuji_panic("sum function expects 1 argument");
+  }
+
+  ArrayNumbers numbers = array_numbers(yuji_dyn_array_get(args, 0), "sum");
+  YujiValue* result;
+
+  if (numbers.kind == YUJI_ARRAY_INT) {
+    int64_t sum;
+
+    if (!yuji_vector_sum_int(numbers.ints, numbers.size, &sum)) {
+      numbers_free(&numbers);
+      yuji_panic("integer overflow in sum");
+    }
+
+    result = yuji_value_int_init(sum);
+  } else {
+    result = yuji_value_float_init(yuji_vector_sum_float(numbers.floats, numbers.size));
+  }
+
+  numbers_free(&numbers);
+  return result;
+}
+
+#define _YUJI_ARRAY_EXTREMUM(NAME) \
+  static YujiValue* array_##NAME(YujiScope* scope, YujiDynArray* args) { \
+    YUJI_UNUSED(scope); \
+    if (args->size != 1) { \
+      yuji_panic(#NAME " function expects 1 argument"); \
+    } \
+    ArrayNumbers numbers = array_numbers(yuji_dyn_array_get(args, 0), #NAME); \
+    if (numbers.size == 0) { \
+      yuji_panic(#NAME " function called on empty array"); \
+    } \
+    YujiValue* result = numbers.kind == YUJI_ARRAY_INT \
+      ? yuji_value_int_init(yuji_vector_##NAME##_int(numbers.ints, numbers.size)) \
+      : yuji_value_float_init(yuji_vector_##NAME##_float(numbers.floats, numbers.size)); \
+    numbers_free(&numbers); \
+    return result; \
+  }
+
+_YUJI_ARRAY_EXTREMUM(min)
+_YUJI_ARRAY_EXTREMUM(max)
+
+static YujiValue* array_dot(YujiScope* scope, YujiDynArray* args) {
+  YUJI_UNUSED(scope);
+
+  if (args->size != 2) {
+    yuji_panic("dot function expects 2 arguments");
+  }
+
+  ArrayNumbers left = array_numbers(yuji_dyn_array_get(args, 0), "dot");
+  YujiValue* right_value = yuji_dyn_array_get(args, 1);
+
+  if (yuji_value_type(right_value) != VT_ARRAY) {
+    yuji_panic("dot function expects an array");
+  }
+
+  ArrayNumbers right = operand_numbers(right_value, left.size, "dot");
+  YujiValue* result;
+
+  // there is no vector 64-bit multiply below AVX-512, integer products stay scalar
+  if (left.kind == YUJI_ARRAY_INT && right.kind == YUJI_ARRAY_INT) {
+    int64_t sum = 0;
+
+    for (size_t i = 0; i < left.size; i++) {
+      int64_t product;
+
+      if (__builtin_mul_overflow(left.ints[i], right.ints[i], &product) ||
+          __builtin_add_overflow(sum, product, &sum)) {
+        numbers_free(&left);
+        numbers_free(&right);
+        yuji_panic("integer overflow in dot");
+      }
+    }
+
+    result = yuji_value_int_init(sum);
+  } else {
+    const double* left_floats = numbers_floats(&left);
+    const double* right_floats = numbers_floats(&right);
+    result = yuji_value_float_init(yuji_vector_dot_float(left_floats, right_floats, left.size));
+  }
+
+  numbers_free(&left);
+  numbers_free(&right);
+  return result;
+}
+
+static YujiValue* array_scale(YujiScope* scope, YujiDynArray* args) {
+  YUJI_UNUSED(scope);
+
+  if (args->size != 2) {
+    yuji_panic("scale function expects 2 arguments");
+  }
+
+  ArrayNumbers numbers = array_numbers(yuji_dyn_array_get(args, 0), "scale");
+  YujiValue* factor = yuji_dyn_array_get(args, 1);
+
+  if (!is_number(factor)) {
+    yuji_panic("scale function expects a number as factor");
+  }
+
+  YujiArray* result;
+
+  if (numbers.kind == YUJI_ARRAY_INT && yuji_value_type(factor) == VT_INT) {
+    int64_t by = yuji_value_as_int(factor);
+    result = yuji_array_alloc(YUJI_ARRAY_INT, numbers.size);
+
+    for (size_t i = 0; i < numbers.size; i++) {
+      if (__builtin_mul_overflow(numbers.ints[i], by, &result->data.ints[i])) {
+        yuji_array_free(result);
+        numbers_free(&numbers);
+        yuji_panic("integer overflow in scale");
+      }
+    }
+  } else {
+    const double* floats = numbers_floats(&numbers);
+    result = yuji_array_alloc(YUJI_ARRAY_FLOAT, numbers.size);
+    yuji_vector_scale_float(result->data.floats, floats, number_value(factor), numbers.size);
+  }
+
+  numbers_free(&numbers);
+  return yuji_value_array_init(result);
+}
+
+static YujiValue* array_add(YujiScope* scope, YujiDynArray* args) {
+  YUJI_UNUSED(scope);
+
+  if (args->size != 2) {
+    yuji_panic("add function expects 2 arguments");
+  }
+
+  ArrayNumbers left = array_numbers(yuji_dyn_array_get(args, 0), "add");
+  ArrayNumbers right = operand_numbers(yuji_dyn_array_get(args, 1), left.size, "add");
+  YujiArray* result;
+
+  if (left.kind == YUJI_ARRAY_INT && right.kind == YUJI_ARRAY_INT) {
+    result = yuji_array_alloc(YUJI_ARRAY_INT, left.size);
+
+    if (!yuji_vector_add_int(result->data.ints, left.ints, right.ints, left.size)) {
+      yuji_array_free(result);
+      numbers_free(&left);
+      numbers_free(&right);
+      yuji_panic("integer overflow in add");
+    }
+  } else {
+    const double* left_floats = numbers_floats(&left);
+    const double* right_floats = numbers_floats(&right);
+    result = yuji_array_alloc(YUJI_ARRAY_FLOAT, left.size);
+    yuji_vector_add_float(result->data.floats, left_floats, right_floats, left.size);
+  }
+
+  numbers_free(&left);
+  numbers_free(&right);
+  return yuji_value_array_init(result);
+}
+
+static YujiValue* array_fill(YujiScope* scope, YujiDynArray* args) {
+  YUJI_UNUSED(scope);
+
+  if (args->size != 2) {
+    yuji_panic("fill function expects 2 arguments");
+  }
+
+  YujiValue* count = yuji_dyn_array_get(args, 0);
+  YujiValue* value = yuji_dyn_array_get(args, 1);
+
+  if (yuji_value_type(count) != VT_INT || yuji_value_as_int(count) < 0) {
+    yuji_panic("fill function expects a non-negative int as count");
+  }
+
+  size_t size = (size_t)yuji_value_as_int(count);
+  YujiArray* result;
+
+  switch (yuji_value_type(value)) {
+    case VT_INT:
+      result = yuji_array_alloc(YUJI_ARRAY_INT, size);
+      yuji_vector_fill((uint64_t*)result->data.ints, (uint64_t)yuji_value_as_int(value), size);
+      break;
+
+    case VT_FLOAT: {
+      double number = yuji_value_as_float(value);
+      uint64_t bits;
+      memcpy(&bits, &number, sizeof(bits));
+
+      result = yuji_array_alloc(YUJI_ARRAY_FLOAT, size);
+      yuji_vector_fill((uint64_t*)result->data.floats, bits, size);
+      break;
+    }
+
+    default:
+      result = yuji_array_alloc(YUJI_ARRAY_GENERIC, size);
+
+      for (size_t i = 0; i < size; i++) {
+        result->data.values[i] = yuji_value_ref(value);
+      }
+      break;
+  }
+
+  return yuji_value_array_init(result);
+}
+
+static YujiValue* array_range(YujiScope* scope, YujiDynArray* args) {
+  YUJI_UNUSED(scope);
+
+  if (args->size < 1 || args->size > 3) {
+    yuji_panic("range function expects 1 to 3 arguments");
+  }
+
+  int64_t bounds[3] = {0, 0, 1};
+
+  for (size_t i = 0; i < args->size; i++) {
+    YujiValue* arg = yuji_dyn_array_get(args, i);
+
+    if (yuji_value_type(arg) != VT_INT) {
+      yuji_panic("range function expects int arguments");
+    }
+
+    bounds[args->size == 1 ? 1 : i] = yuji_value_as_int(arg);
+  }
+
+  int64_t start = bounds[0];
+  int64_t end = bounds[1];
+  int64_t step = bounds[2];
+
+  if (step == 0) {
+    yuji_panic("range function expects a non-zero step");
+  }
+
+  // the distance is computed unsigned, it can exceed INT64_MAX
+  uint64_t span = 0;
+  uint64_t stride = step > 0 ? (uint64_t)step : -(uint64_t)step;
+
+  if (step > 0 && end > start) {
+    span = (uint64_t)end - (uint64_t)start;
+  } else if (step < 0 && start > end) {
+    span = (uint64_t)start - (uint64_t)end;
+  }
+
+  size_t size = (size_t)(span / stride + (span % stride != 0));
+  YujiArray* result = yuji_array_alloc(YUJI_ARRAY_INT, size);
+  yuji_vector_range(result->data.ints, start, step, size);
+
+  return yuji_value_array_init(result);
+}
+
+// element-wise comparison into an array of bools, which are written as the
+// encoded values directly
+static YujiValue* array_compare(YujiDynArray* args, YujiOperator op, const char* function_name) {
+  ArrayNumbers left = array_numbers(yuji_dyn_array_get(args, 0), function_name);
+  ArrayNumbers right = operand_numbers(yuji_dyn_array_get(args, 1), left.size, function_name);
+
+  YujiArray* result = yuji_array_alloc(YUJI_ARRAY_GENERIC, left.size);
+  uint64_t* out = (uint64_t*)result->data.values;
+  uint64_t if_true = (uint64_t)(uintptr_t)yuji_value_bool_init(true);
+  uint64_t if_false = (uint64_t)(uintptr_t)yuji_value_bool_init(false);
+
+  if (left.kind == YUJI_ARRAY_INT && right.kind == YUJI_ARRAY_INT) {
+    yuji_vector_compare_int(out, left.ints, right.ints, left.size, op, if_true, if_false);
+  } else {
+    const double* left_floats = numbers_floats(&left);
+    const double* right_floats = numbers_floats(&right);
+    yuji_vector_compare_float(out, left_floats, right_floats, left.size, op, if_true, if_false);
+  }
+
+  numbers_free(&left);
+  numbers_free(&right);
+  return yuji_value_array_init(result);
+}
+
+#define _YUJI_ARRAY_COMPARE(NAME, OPERATOR) \
+  static YujiValue* array_##NAME(YujiScope* scope, YujiDynArray* args) { \
+    YUJI_UNUSED(scope); \
+    if (args->size != 2) { \
+      yuji_panic(#NAME " function expects 2 arguments"); \
+    } \
+    return array_compare(args, OPERATOR, #NAME); \
+  }
+
+_YUJI_ARRAY_COMPARE(less, YUJI_OPERATOR_LT)
+_YUJI_ARRAY_COMPARE(greater, YUJI_OPERATOR_GT)
+_YUJI_ARRAY_COMPARE(less_equal, YUJI_OPERATOR_LTE)
+_YUJI_ARRAY_COMPARE(greater_equal, YUJI_OPERATOR_GTE)
+_YUJI_ARRAY_COMPARE(equal, YUJI_OPERATOR_EQ)
+_YUJI_ARRAY_COMPARE(not_equal, YUJI_OPERATOR_NEQ)
+
+static YujiArray* array_arg(YujiDynArray* args, const char* function_name) {
+  YujiValue* array = yuji_dyn_array_get(args, 0);
+
+  if (yuji_value_type(array) != VT_ARRAY) {
+    yuji_panic("%s function expects an array", function_name);
+  }
+
+  return array->value.array;
+}
+
+// prepares the function argument for calls with `argc` arguments, on the
+// interpreter that called the native function
+static void callback_arg(YujiCallback* callback, YujiScope* scope, YujiDynArray* args,
+                         size_t index, size_t argc) {
+  if (!scope || !scope->interpreter) {
+    yuji_panic("array callbacks need a running interpreter");
+  }
+
+  yuji_callback_init(callback, scope->interpreter, yuji_dyn_array_get(args, index), argc,
+                     "<callback>");
+}
+
+// calls a one-argument callback with the element at `index` and hands the
+// reference passed to it over in `element`. the callback may change the
+// array, so callers keep that reference rather than reading the slot again
+static YujiValue* callback_element(YujiCallback* callback, YujiArray* array, size_t index,
+                                   YujiValue** element) {
+  *element = yuji_array_get(array, index);
+  callback->args[0] = *element;
+
+  return yuji_callback_call(callback);
+}
+
+static YujiValue* array_map(YujiScope* scope, YujiDynArray* args) {
+  if (args->size != 2) {
+    yuji_panic("map function expects 2 arguments");
+  }
+
+  YujiArray* array = array_arg(args, "map");
+  YujiCallback callback;
+  callback_arg(&callback, scope, args, 1, 1);
+
+  YujiArray* result = yuji_array_init(array->size);
+
+  for (size_t i = 0; i < array->size; i++) {
+    YujiValue* element;
+    yuji_array_push(result, callback_element(&callback, array, i, &element));
+    yuji_value_free(element);
+  }
+
+  yuji_callback_free(&callback);
+  return yuji_value_array_init(result);
+}
+
+static YujiValue* array_filter(YujiScope* scope, YujiDynArray* args) {
+  if (args->size != 2) {
+    yuji_panic("filter function expects 2 arguments");
+  }
+
+  YujiArray* array = array_arg(args, "filter");
+  YujiCallback callback;
+  callback_arg(&callback, scope, args, 1, 1);
+
+  YujiArray* result = yuji_array_init(0);
+
+  for (size_t i = 0; i < array->size; i++) {
+    YujiValue* element;
+    YujiValue* keep = callback_element(&callback, array, i, &element);
+
+    if (yuji_value_to_bool(keep)) {
+      yuji_array_push(result, element);
+    } else {
+      yuji_value_free(element);
+    }
+
+    yuji_value_free(keep);
+  }
+
+  yuji_callback_free(&callback);
+  return yuji_value_array_init(result);
+}
+
+static YujiValue* array_reduce(YujiScope* scope, YujiDynArray* args) {
+  if (args->size != 2 && args->size != 3) {
+    yuji_panic("reduce function expects 2 or 3 arguments");
+  }
+
+  YujiArray* array = array_arg(args, "reduce");
+  YujiCallback callback;
+  callback_arg(&callback, scope, args, 1, 2);
+
+  size_t i = 0;
+  YujiValue* accumulator;
+
+  if (args->size == 3) {
+    accumulator = yuji_value_ref(yuji_dyn_array_get(args, 2));
+  } else if (array->size > 0) {
+    accumulator = yuji_array_get(array, i++);
+  } else {
+    yuji_panic("reduce function called on empty array without an initial value");
+  }
+
+  for (; i < array->size; i++) {
+    YujiValue* element = yuji_array_get(array, i);
+    callback.args[0] = accumulator;
+    callback.args[1] = element;
+
+    YujiValue* next = yuji_callback_call(&callback);
+    yuji_value_free(accumulator);
+    yuji_value_free(element);
+    accumulator = next;
+  }
+
+  yuji_callback_free(&callback);
+  return accumulator;
+}
+
+static YujiValue* array_each(YujiScope* scope, YujiDynArray* args) {
+  if (args->size != 2) {
+    yuji_panic("each function expects 2 arguments");
+  }
+
+  YujiArray* array = array_arg(args, "each");
+  YujiCallback callback;
+  callback_arg(&callback, scope, args, 1, 1);
+
+  for (size_t i = 0; i < array->size; i++) {
+    YujiValue* element;
+    yuji_value_free(callback_element(&callback, array, i, &element));
+    yuji_value_free(element);
+  }
+
+  yuji_callback_free(&callback);
+  return yuji_value_null_init();
+}
+
+static YujiValue* array_find(YujiScope* scope, YujiDynArray* args) {
+  if (args->size != 2) {
+    yuji_panic("find function expects 2 arguments");
+  }
+
+  YujiArray* array = array_arg(args, "find");
+  YujiCallback callback;
+  callback_arg(&callback, scope, args, 1, 1);
+
+  YujiValue* found = yuji_value_null_init();
+
+  for (size_t i = 0; i < array->size; i++) {
+    YujiValue* element;
+    YujiValue* matches = callback_element(&callback, array, i, &element);
+    bool match = yuji_value_to_bool(matches);
+    yuji_value_free(matches);
+
+    if (match) {
+      yuji_value_free(found);
+      found = element;
+      break;
+    }
+
+    yuji_value_free(element);
+  }
+
+  yuji_callback_free(&callback);
+  return found;
+}
+
+// SORT
+
+// runs shorter than this are extended with insertion sort before merging
+#define SORT_MIN_RUN 32
+
+// the slots of every array kind are 8 bytes wide and sorted as such
+typedef union {
+  int64_t int_;
+  double float_;
+  YujiValue* value;
+} ArraySlot;
+
+typedef struct {
+  YujiArrayKind kind;
+  YujiCallback* comparator; // NULL for the natural order
+} SortOrder;
+
+static YujiValue* slot_value(const SortOrder* order, ArraySlot slot) {
+  switch (order->kind) {
+    case YUJI_ARRAY_INT:
+      return yuji_value_int_init(slot.int_);
+
+    case YUJI_ARRAY_FLOAT:
+      return yuji_value_float_init(slot.float_);
+
+    default:
+      return yuji_value_ref(slot.value);
+  }
+}
+
+static bool slot_less(const SortOrder* order, ArraySlot left, ArraySlot right) {
+  if (!order->comparator) {
+    switch (order->kind) {
+      case YUJI_ARRAY_INT:
+        return left.int_ < right.int_;
+
+      case YUJI_ARRAY_FLOAT:
+        return left.float_ < right.float_;
+
+      default: {
+        YujiValue* less = yuji_operator_eval(YUJI_OPERATOR_LT, left.value, right.value);
+        bool result = yuji_value_to_bool(less);
+        yuji_value_free(less);
+        return result;
+      }
+    }
+  }
+
+  YujiCallback* comparator = order->comparator;
+  comparator->args[0] = slot_value(order, left);
+  comparator->args[1] = slot_value(order, right);
+
+  YujiValue* less = yuji_callback_call(comparator);
+  bool result = yuji_value_to_bool(less);
+
+  yuji_value_free(less);
+  yuji_value_free(comparator->args[0]);
+  yuji_value_free(comparator->args[1]);
+
+  return result;
+}
+
+// sorts slots[start, end) of which [start, sorted) already are
+static void sort_insertion(const SortOrder* order, ArraySlot* slots, size_t start, size_t sorted,
+                           size_t end) {
+  for (size_t i = sorted; i < end; i++) {
+    ArraySlot slot = slots[i];
+    size_t low = start;
+    size_t high = i;
+
+    // the first position whose slot is greater, which keeps equal slots in order
+    while (low < high) {
+      size_t mid = low + (high - low) / 2;
+
+      if (slot_less(order, slot, slots[mid])) {
+        high = mid;
+      } else {
+        low = mid + 1;
+      }
+    }
+
+    memmove(slots + low + 1, slots + low, sizeof(ArraySlot) * (i - low));
+    slots[low] = slot;
+  }
+}
+
+// the end of the run starting at `start`. a strictly descending run is
+// reversed, which cannot reorder equal slots
+static size_t sort_run(const SortOrder* order, ArraySlot* slots, size_t start, size_t size) {
+  size_t end = start + 1;
+
+  if (end == size) {
+    return end;
+  }
+
+  if (slot_less(order, slots[end], slots[start])) {
+    while (end + 1 < size && slot_less(order, slots[end + 1], slots[end])) {
+      end++;
+    }
+
+    for (size_t low = start, high = end; low < high; low++, high--) {
+      ArraySlot tmp = slots[low];
+      slots[low] = slots[high];
+      slots[high] = tmp;
+    }
+  } else {
+    while (end + 1 < size && !slot_less(order, slots[end + 1], slots[end])) {
+      end++;
+    }
+  }
+
+  return end + 1;
+}
+
+// merges the sorted ranges [start, middle) and [middle, end), taking from
+// the left on ties
+static void sort_merge(const SortOrder* order, ArraySlot* slots, ArraySlot* buffer, size_t start,
+                       size_t middle, size_t end) {
+  // already in order, nothing to copy
+  if (!slot_less(order, slots[middle], slots[middle - 1])) {
+    return;
+  }
+
+  memcpy(buffer, slots + start, sizeof(ArraySlot) * (middle - start));
+
+  size_t left = 0;
+  size_t left_end = middle - start;
+  size_t right = middle;
+  size_t out = start;
+
+  while (left < left_end && right < end) {
+    if (slot_less(order, slots[right], buffer[left])) {
+      slots[out++] = slots[right++];
+    } else {
+      slots[out++] = buffer[left++];
+    }
+  }
+
+  memcpy(slots + out, buffer + left, sizeof(ArraySlot) * (left_end - left));
+}
+
+// natural merge sort: existing runs are found, short ones extended to
+// SORT_MIN_RUN with binary insertion, then neighbouring runs are merged
+// until one is left. stable, and linear on input that is already sorted
+static void sort_slots(const SortOrder* order, ArraySlot* slots, size_t size) {
+  if (size < 2) {
+    return;
+  }
+
+  YujiDynArray* runs = yuji_dyn_array_init();
+  size_t start = 0;
+
+  while (start < size) {
+    size_t end = sort_run(order, slots, start, size);
+
+    if (end - start < SORT_MIN_RUN && end < size) {
+      size_t extended = start + SORT_MIN_RUN < size ? start + SORT_MIN_RUN : size;
+      sort_insertion(order, slots, start, end, extended);
+      end = extended;
+    }
+
+    yuji_dyn_array_push(runs, (void*)(uintptr_t)end);
+    start = end;
+  }
+
+  ArraySlot* buffer = yuji_malloc(sizeof(ArraySlot) * size);
+
+  // each pass merges pairs of runs, halving their number
+  while (runs->size > 1) {
+    size_t merged = 0;
+    size_t run_start = 0;
+
+    for (size_t i = 0; i < runs->size; i += 2) {
+      size_t middle = (size_t)(uintptr_t)runs->data[i];
+
+      if (i + 1 == runs->size) {
+        runs->data[merged++] = runs->data[i];
+        break;
+      }
+
+      size_t end = (size_t)(uintptr_t)runs->data[i + 1];
+      sort_merge(order, slots, buffer, run_start, middle, end);
+      runs->data[merged++] = (void*)(uintptr_t)end;
+      run_start = end;
+    }
+
+    runs->size = merged;
+  }
+
+  yuji_free(buffer);
+  yuji_dyn_array_free(runs);
+}
+
+static YujiValue* array_sort(YujiScope* scope, YujiDynArray* args) {
+  if (args->size != 1 && args->size != 2) {
+    yuji_panic("sort function expects 1 or 2 arguments");
+  }
+
+  YujiValue* value = yuji_dyn_array_get(args, 0);
+  YujiArray* array = array_arg(args, "sort");
+  YujiCallback comparator;
+  SortOrder order = {array->kind, NULL};
+
+  if (args->size == 2) {
+    callback_arg(&comparator, scope, args, 1, 2);
+    order.comparator = &comparator;
+  }
+
+  // a comparator may change the array, so a copy is sorted that holds its
+  // own references and replaces the elements at the end
+  size_t size = array->size;
+  ArraySlot* slots = yuji_malloc(sizeof(ArraySlot) * (size + 1));
+  memcpy(slots, array->data.values, sizeof(ArraySlot) * size);
+
+  if (order.kind == YUJI_ARRAY_GENERIC) {
+    for (size_t i = 0; i < size; i++) {
+      yuji_value_ref(slots[i].value);
+    }
+  }
+
+  sort_slots(&order, slots, size);
+
+  if (array->size != size || array->kind != order.kind) {
+    yuji_panic("sort function: array changed while sorting");
+  }
+
+  if (order.kind == YUJI_ARRAY_GENERIC) {
+    for (size_t i = 0; i < size; i++) {
+      yuji_value_free(array->data.values[i]);
+    }
+  }
+
+  memcpy(array->data.values, slots, sizeof(ArraySlot) * size);
+  yuji_free(slots);
+
+  if (order.comparator) {
+    yuji_callback_free(&comparator);
+  }
 
-  return value;
+  return yuji_value_ref(value);
 }
 
 YUJI_DEFINE_MODULE(array, {
   YUJI_MODULE_REGISTER_FUNC(module, "len", YUJI_FN_ARGC(1), array_len);
   YUJI_MODULE_REGISTER_FUNC(module, "push", YUJI_FN_ARGC(2), array_push);
   YUJI_MODULE_REGISTER_FUNC(module, "pop", YUJI_FN_ARGC(1), array_pop);
+  YUJI_MODULE_REGISTER_FUNC(module, "sum", YUJI_FN_ARGC(1), array_sum);
+  YUJI_MODULE_REGISTER_FUNC(module, "min", YUJI_FN_ARGC(1), array_min);
+  YUJI_MODULE_REGISTER_FUNC(module, "max", YUJI_FN_ARGC(1), array_max);
+  YUJI_MODULE_REGISTER_FUNC(module, "dot", YUJI_FN_ARGC(2), array_dot);
+  YUJI_MODULE_REGISTER_FUNC(module, "scale", YUJI_FN_ARGC(2), array_scale);
+  YUJI_MODULE_REGISTER_FUNC(module, "add", YUJI_FN_ARGC(2), array_add);
+  YUJI_MODULE_REGISTER_FUNC(module, "fill", YUJI_FN_ARGC(2), array_fill);
+  YUJI_MODULE_REGISTER_FUNC(module, "range", YUJI_FN_INF_ARGUMENT, array_range);
+  YUJI_MODULE_REGISTER_FUNC(module, "less", YUJI_FN_ARGC(2), array_less);
+  YUJI_MODULE_REGISTER_FUNC(module, "greater", YUJI_FN_ARGC(2), array_greater);
+  YUJI_MODULE_REGISTER_FUNC(module, "less_equal", YUJI_FN_ARGC(2), array_less_equal);
+  YUJI_MODULE_REGISTER_FUNC(module, "greater_equal", YUJI_FN_ARGC(2), array_greater_equal);
+  YUJI_MODULE_REGISTER_FUNC(module, "equal", YUJI_FN_ARGC(2), array_equal);
+  YUJI_MODULE_REGISTER_FUNC(module, "not_equal", YUJI_FN_ARGC(2), array_not_equal);
+  YUJI_MODULE_REGISTER_FUNC(module, "map", YUJI_FN_ARGC(2), array_map);
+  YUJI_MODULE_REGISTER_FUNC(module, "filter", YUJI_FN_ARGC(2), array_filter);
+  YUJI_MODULE_REGISTER_FUNC(module, "reduce", YUJI_FN_INF_ARGUMENT, array_reduce);
+  YUJI_MODULE_REGISTER_FUNC(module, "each", YUJI_FN_ARGC(2), array_each);
+  YUJI_MODULE_REGISTER_FUNC(module, "find", YUJI_FN_ARGC(2), array_find);
+  YUJI_MODULE_REGISTER_FUNC(module, "sort", YUJI_FN_INF_ARGUMENT, array_sort);
 })
@@ -6,6 +6,7 @@
 #include "yuji/core/interpreter.h"
 #include "yuji/utils.h"
 #include <stdlib.h>
+#include <string.h>
 
 static YujiValue* core_not(YujiScope* scope, YujiDynArray* args) {
   YUJI_UNUSED(scope);
@@ -27,12 +28,8 @@ static YujiValue* core_typeof(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* value = yuji_dyn_array_get(args, 0);
 
-  const char* type_str = yuji_value_type_to_string(value->type);
-  YujiString* str = yuji_string_init_from_cstr(type_str);
-  YujiValue* result = yuji_value_string_init(str);
-  yuji_string_free(str);
-
-  return result;
+  const char* type_str = yuji_value_type_to_string(yuji_value_type(value));
+  return yuji_value_string_adopt_init(yuji_string_init_shared(type_str, strlen(type_str), NULL));
 }
 
 static YujiValue* core_assert(YujiScope* scope, YujiDynArray* args) {
@@ -91,11 +88,11 @@ static YujiValue* core_exit(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* code = yuji_dyn_array_get(args, 0);
 
-  if (!yuji_value_type_is(code->type, VT_INT)) {
+  if (!yuji_value_type_is(yuji_value_type(code), VT_INT)) {
     yuji_panic("exit function expects an int argument, got %s", yuji_value_to_string(code));
   }
 
-  int exit_code = (int)code->value.int_;
+  int exit_code = (int)yuji_value_as_int(code);
 
   exit(exit_code);
 
@@ -111,7 +108,7 @@ static YujiValue* core_to_number(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* value = yuji_dyn_array_get(args, 0);
 
-  if (!yuji_value_type_is(value->type, VT_STRING)) {
+  if (!yuji_value_type_is(yuji_value_type(value), VT_STRING)) {
     yuji_panic("to_number function expects a string argument, got %s", yuji_value_to_string(value));
   }
 
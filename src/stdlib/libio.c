@@ -44,6 +44,11 @@ static YujiValue* io_print(YujiScope* scope, YujiDynArray* args) {
   }
 
   YUJI_DYN_ARRAY_ITER(args, YujiValue, arg, {
+    if (yuji_value_type_is(yuji_value_type(arg), VT_STRING)) {
+      fwrite(arg->value.string->data, 1, arg->value.string->size, stdout);
+      continue;
+    }
+
     char* str = yuji_value_to_string(arg);
     printf("%s", str);
     yuji_free(str);
@@ -77,9 +82,7 @@ static YujiValue* io_input(YujiScope* scope, YujiDynArray* args) {
     yuji_string_append_cstr(result, buffer);
   }
 
-  YujiValue* val = yuji_value_string_init(result);
-  yuji_string_free(result);
-  return val;
+  return yuji_value_string_adopt_init(result);
 }
 
 static YujiValue* io_format(YujiScope* scope, YujiDynArray* args) {
@@ -91,15 +94,24 @@ static YujiValue* io_format(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* fmt_val = yuji_dyn_array_get(args, 0);
 
-  if (!yuji_value_type_is(fmt_val->type, VT_STRING)) {
+  if (!yuji_value_type_is(yuji_value_type(fmt_val), VT_STRING)) {
     yuji_panic("format function expects a string as first argument");
   }
 
   char* fmt = fmt_val->value.string->data;
+
+  // nothing to substitute, hand the format string back
+  if (args->size == 1 && !strstr(fmt, "{}")) {
+    return yuji_value_ref(fmt_val);
+  }
+
   YujiString* result = yuji_string_init();
+  yuji_string_reserve(result, fmt_val->value.string->size);
 
   size_t arg_index = 1;
+  size_t literal_start = 0;
 
+  // text between placeholders is copied in one go
   for (size_t i = 0; fmt[i] != '\0'; i++) {
     if (fmt[i] == '{' && fmt[i + 1] == '}') {
       if (arg_index >= args->size) {
@@ -107,19 +119,25 @@ static YujiValue* io_format(YujiScope* scope, YujiDynArray* args) {
         yuji_panic("format: not enough arguments for placeholders");
       }
 
+      yuji_string_append(result, fmt + literal_start, i - literal_start);
+
       YujiValue* val = yuji_dyn_array_get(args, arg_index++);
-      char* val_str = yuji_value_to_string(val);
-      yuji_string_append_cstr(result, val_str);
-      yuji_free(val_str);
+
+      if (yuji_value_type_is(yuji_value_type(val), VT_STRING)) {
+        yuji_string_append(result, val->value.string->data, val->value.string->size);
+      } else {
+        char* val_str = yuji_value_to_string(val);
+        yuji_string_append_cstr(result, val_str);
+        yuji_free(val_str);
+      }
+
       i++;
-    } else {
-      yuji_string_append_char(result, fmt[i]);
+      literal_start = i + 1;
     }
   }
 
-  YujiValue* formatted = yuji_value_string_init(result);
-  yuji_string_free(result);
-  return formatted;
+  yuji_string_append(result, fmt + literal_start, strlen(fmt + literal_start));
+  return yuji_value_string_adopt_init(result);
 }
 
 static YujiValue* io_open(YujiScope* scope, YujiDynArray* args) {
@@ -132,9 +150,9 @@ static YujiValue* io_open(YujiScope* scope, YujiDynArray* args) {
   YujiValue* name = yuji_dyn_array_get(args, 0);
   YujiValue* mode = yuji_dyn_array_get(args, 1);
 
-  if (name->type != VT_STRING) {
+  if (yuji_value_type(name) != VT_STRING) {
     yuji_panic("open function expects an string argument, got %s", yuji_value_to_string(name));
-  } else if (mode->type != VT_STRING) {
+  } else if (yuji_value_type(mode) != VT_STRING) {
     yuji_panic("open function expects an string argument, got %s", yuji_value_to_string(mode));
   }
 
@@ -156,11 +174,11 @@ static YujiValue* io_close(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* fd = yuji_dyn_array_get(args, 0);
 
-  if (fd->type != VT_INT) {
+  if (yuji_value_type(fd) != VT_INT) {
     yuji_panic("close function expects an int argument, got %s", yuji_value_to_string(fd));
   }
 
-  close((int)fd->value.int_);
+  close((int)yuji_value_as_int(fd));
 
   return yuji_value_null_init();
 }
@@ -175,19 +193,19 @@ static YujiValue* io_write(YujiScope* scope, YujiDynArray* args) {
   YujiValue* fd = yuji_dyn_array_get(args, 0);
   YujiValue* data = yuji_dyn_array_get(args, 1);
 
-  if (fd->type != VT_INT) {
+  if (yuji_value_type(fd) != VT_INT) {
     yuji_panic("write function expects an int argument, got %s", yuji_value_to_string(fd));
-  } else if (data->type != VT_STRING) {
+  } else if (yuji_value_type(data) != VT_STRING) {
     yuji_panic("write function expects an string argument, got %s", yuji_value_to_string(fd));
   }
 
-  ssize_t r = write((int)fd->value.int_, data->value.string->data, data->value.string->size);
+  ssize_t r = write((int)yuji_value_as_int(fd), data->value.string->data, data->value.string->size);
 
   if (r < 0) {
     yuji_panic("write failed: %s", strerror(errno));
   }
 
-  fsync((int)fd->value.int_);
+  fsync((int)yuji_value_as_int(fd));
 
   return yuji_value_null_init();
 }
@@ -201,7 +219,7 @@ static YujiValue* io_read(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* fd = yuji_dyn_array_get(args, 0);
 
-  if (fd->type != VT_INT) {
+  if (yuji_value_type(fd) != VT_INT) {
     yuji_panic("read expects int fd");
   }
 
@@ -211,7 +229,7 @@ static YujiValue* io_read(YujiScope* scope, YujiDynArray* args) {
 
   ssize_t n;
 
-  while ((n = read((int)fd->value.int_, buf, 4096)) > 0) {
+  while ((n = read((int)yuji_value_as_int(fd), buf, 4096)) > 0) {
     yuji_string_append(str, buf, (size_t)n);
   }
 
@@ -220,9 +238,7 @@ static YujiValue* io_read(YujiScope* scope, YujiDynArray* args) {
     yuji_panic("read failed: %s", strerror(errno));
   }
 
-  YujiValue* v = yuji_value_string_init(str);
-  yuji_string_free(str);
-  return v;
+  return yuji_value_string_adopt_init(str);
 }
 
 YUJI_DEFINE_MODULE(io, {
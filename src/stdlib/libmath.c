@@ -6,6 +6,11 @@
 #include <math.h>
 #include <stdlib.h>
 
+static double number_value(YujiValue* value) {
+  return yuji_value_type(value) == VT_INT ? (double)yuji_value_as_int(value)
+                                          : yuji_value_as_float(value);
+}
+
 static YujiValue* math_sin(YujiScope* scope, YujiDynArray* args) {
   YUJI_UNUSED(scope);
 
@@ -15,11 +20,11 @@ static YujiValue* math_sin(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* arg = yuji_dyn_array_get(args, 0);
 
-  if (arg->type != VT_INT && arg->type != VT_FLOAT) {
+  if (yuji_value_type(arg) != VT_INT && yuji_value_type(arg) != VT_FLOAT) {
     yuji_panic("sin function expects a int or float");
   }
 
-  double value = arg->type == VT_INT ? (double)arg->value.int_ : arg->value.float_;
+  double value = number_value(arg);
 
   return yuji_value_float_init(sin(value));
 }
@@ -33,11 +38,11 @@ static YujiValue* math_cos(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* arg = yuji_dyn_array_get(args, 0);
 
-  if (arg->type != VT_INT && arg->type != VT_FLOAT) {
+  if (yuji_value_type(arg) != VT_INT && yuji_value_type(arg) != VT_FLOAT) {
     yuji_panic("cos function expects a int or float");
   }
 
-  double value = arg->type == VT_INT ? (double)arg->value.int_ : arg->value.float_;
+  double value = number_value(arg);
 
   return yuji_value_float_init(cos(value));
 }
@@ -51,11 +56,11 @@ static YujiValue* math_tan(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* arg = yuji_dyn_array_get(args, 0);
 
-  if (arg->type != VT_INT && arg->type != VT_FLOAT) {
+  if (yuji_value_type(arg) != VT_INT && yuji_value_type(arg) != VT_FLOAT) {
     yuji_panic("tan function expects a int or float");
   }
 
-  double value = arg->type == VT_INT ? (double)arg->value.int_ : arg->value.float_;
+  double value = number_value(arg);
 
   return yuji_value_float_init(tan(value));
 }
@@ -70,17 +75,16 @@ static YujiValue* math_pow(YujiScope* scope, YujiDynArray* args) {
   YujiValue* base = yuji_dyn_array_get(args, 0);
   YujiValue* exponent = yuji_dyn_array_get(args, 1);
 
-  if (base->type != VT_INT && base->type != VT_FLOAT) {
+  if (yuji_value_type(base) != VT_INT && yuji_value_type(base) != VT_FLOAT) {
     yuji_panic("pow function expects a int or float as base");
   }
 
-  if (exponent->type != VT_INT && exponent->type != VT_FLOAT) {
+  if (yuji_value_type(exponent) != VT_INT && yuji_value_type(exponent) != VT_FLOAT) {
     yuji_panic("pow function expects a int or float as exponent");
   }
 
-  double base_value = base->type == VT_INT ? (double)base->value.int_ : base->value.float_;
-  double exponent_value = exponent->type == VT_INT ? (double)exponent->value.int_ :
-                          exponent->value.float_;
+  double base_value = number_value(base);
+  double exponent_value = number_value(exponent);
 
   return yuji_value_float_init(pow(base_value, exponent_value));
 }
@@ -94,11 +98,11 @@ static YujiValue* math_sqrt(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* arg = yuji_dyn_array_get(args, 0);
 
-  if (arg->type != VT_INT && arg->type != VT_FLOAT) {
+  if (yuji_value_type(arg) != VT_INT && yuji_value_type(arg) != VT_FLOAT) {
     yuji_panic("sqrt function expects a int or float");
   }
 
-  double value = arg->type == VT_INT ? (double)arg->value.int_ : arg->value.float_;
+  double value = number_value(arg);
 
   return yuji_value_float_init(sqrt(value));
 }
@@ -112,11 +116,11 @@ static YujiValue* math_abs(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* arg = yuji_dyn_array_get(args, 0);
 
-  if (arg->type != VT_INT && arg->type != VT_FLOAT) {
+  if (yuji_value_type(arg) != VT_INT && yuji_value_type(arg) != VT_FLOAT) {
     yuji_panic("abs function expects a int or float");
   }
 
-  double value = arg->type == VT_INT ? (double)arg->value.int_ : arg->value.float_;
+  double value = number_value(arg);
 
   return yuji_value_float_init(fabs(value));
 }
@@ -130,11 +134,11 @@ static YujiValue* math_floor(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* arg = yuji_dyn_array_get(args, 0);
 
-  if (arg->type != VT_INT && arg->type != VT_FLOAT) {
+  if (yuji_value_type(arg) != VT_INT && yuji_value_type(arg) != VT_FLOAT) {
     yuji_panic("floor function expects a int or float");
   }
 
-  double value = arg->type == VT_INT ? (double)arg->value.int_ : arg->value.float_;
+  double value = number_value(arg);
 
   return yuji_value_float_init(floor(value));
 }
@@ -148,11 +152,11 @@ static YujiValue* math_ceil(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* arg = yuji_dyn_array_get(args, 0);
 
-  if (arg->type != VT_INT && arg->type != VT_FLOAT) {
+  if (yuji_value_type(arg) != VT_INT && yuji_value_type(arg) != VT_FLOAT) {
     yuji_panic("ceil function expects a int or float");
   }
 
-  double value = arg->type == VT_INT ? (double)arg->value.int_ : arg->value.float_;
+  double value = number_value(arg);
 
   return yuji_value_float_init(ceil(value));
 }
@@ -166,11 +170,11 @@ static YujiValue* math_round(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* arg = yuji_dyn_array_get(args, 0);
 
-  if (arg->type != VT_INT && arg->type != VT_FLOAT) {
+  if (yuji_value_type(arg) != VT_INT && yuji_value_type(arg) != VT_FLOAT) {
     yuji_panic("round function expects a int or float");
   }
 
-  double value = arg->type == VT_INT ? (double)arg->value.int_ : arg->value.float_;
+  double value = number_value(arg);
 
   return yuji_value_float_init(round(value));
 }
@@ -185,12 +189,12 @@ static YujiValue* math_random(YujiScope* scope, YujiDynArray* args) {
   YujiValue* min_arg = yuji_dyn_array_get(args, 0);
   YujiValue* max_arg = yuji_dyn_array_get(args, 1);
 
-  if (min_arg->type != VT_INT || max_arg->type != VT_INT) {
+  if (yuji_value_type(min_arg) != VT_INT || yuji_value_type(max_arg) != VT_INT) {
     yuji_panic("random function expects integers");
   }
 
-  int64_t min = min_arg->value.int_;
-  int64_t max = max_arg->value.int_;
+  int64_t min = yuji_value_as_int(min_arg);
+  int64_t max = yuji_value_as_int(max_arg);
 
   if (min >= max) {
     yuji_panic("min must be less than max");
@@ -16,7 +16,7 @@ static YujiValue* os_system(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* arg = yuji_dyn_array_get(args, 0);
 
-  if (arg->type != VT_STRING) {
+  if (yuji_value_type(arg) != VT_STRING) {
     yuji_panic("system function expects a string argument");
   }
 
@@ -34,7 +34,7 @@ static YujiValue* os_setenv(YujiScope* scope, YujiDynArray* args) {
   YujiValue* key = yuji_dyn_array_get(args, 0);
   YujiValue* value = yuji_dyn_array_get(args, 1);
 
-  if (key->type != VT_STRING || value->type != VT_STRING) {
+  if (yuji_value_type(key) != VT_STRING || yuji_value_type(value) != VT_STRING) {
     yuji_panic("setenv function expects string arguments");
   }
 
@@ -51,12 +51,12 @@ static YujiValue* os_getenv(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* key = yuji_dyn_array_get(args, 0);
 
-  if (key->type != VT_STRING) {
+  if (yuji_value_type(key) != VT_STRING) {
     yuji_panic("getenv function expects a string argument");
   }
 
   char* result = getenv(key->value.string->data);
-  return yuji_value_string_init(yuji_string_init_from_cstr(result));
+  return yuji_value_string_adopt_init(yuji_string_init_from_cstr(result));
 }
 
 
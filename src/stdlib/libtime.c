@@ -26,11 +26,11 @@ static YujiValue* time_sleep(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* duration = yuji_dyn_array_get(args, 0);
 
-  if (duration->type != VT_INT) {
+  if (yuji_value_type(duration) != VT_INT) {
     yuji_panic("sleep function takes an integer argument");
   }
 
-  time_t seconds = duration->value.int_;
+  time_t seconds = yuji_value_as_int(duration);
   struct timespec ts = {
     .tv_sec = seconds,
     .tv_nsec = 0
@@ -52,11 +52,11 @@ static YujiValue* time_sleepms(YujiScope* scope, YujiDynArray* args) {
 
   YujiValue* duration = yuji_dyn_array_get(args, 0);
 
-  if (duration->type != VT_INT) {
+  if (yuji_value_type(duration) != VT_INT) {
     yuji_panic("sleepms function takes an integer argument");
   }
 
-  time_t milliseconds = duration->value.int_;
+  time_t milliseconds = yuji_value_as_int(duration);
   struct timespec ts = {
     .tv_sec = milliseconds / 1000,
     .tv_nsec = (milliseconds % 1000) * 1000000